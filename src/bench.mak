@@ -0,0 +1,52 @@
+#	$Id$
+#
+#	Copyright (c) 2026, amigazen project
+#
+#	Development makefile for benchmarking ctags against deterministic
+#	synthetic corpora (see bench/gencorpus.sh). Results are printed one line
+#	per corpus, in a format which may be compared between builds with diff.
+
+CTAGS_BENCH = ctags
+BENCH_CORPUS = bench.corpus
+BENCH_RUNS = 3
+BENCH_SCALE = 1
+BENCH_OPTIONS =
+BENCH_CORPORA =
+BENCH_DRIVER = bench/bench.sh
+
+MICROBENCH_PROGS = vstrbench kwbench rebench sortbench findbench
+MICROBENCH_INPUT = c.c
+MICROBENCH_OBJS = vstring.o routines.o
+
+vstrbench_OBJS = $(MICROBENCH_OBJS)
+kwbench_OBJS = keyword.o $(MICROBENCH_OBJS)
+rebench_OBJS = regexp.o $(MICROBENCH_OBJS)
+sortbench_OBJS = sort.o intern.o strlist.o $(MICROBENCH_OBJS)
+findbench_OBJS = readtags.o $(MICROBENCH_OBJS)
+
+.PHONY: bench bench.corpus microbench clean-bench
+
+bench: $(CTAGS_BENCH)
+	@ BENCH_RUNS="$(BENCH_RUNS)" BENCH_SCALE="$(BENCH_SCALE)" \
+	  BENCH_OPTIONS="$(BENCH_OPTIONS)" BENCH_CORPORA="$(BENCH_CORPORA)" \
+	  sh $(BENCH_DRIVER) ./$(CTAGS_BENCH) $(BENCH_CORPUS)
+
+bench.corpus:
+	@ sh bench/gencorpus.sh $(BENCH_CORPUS) $(BENCH_SCALE)
+
+microbench: $(MICROBENCH_PROGS) $(CTAGS_BENCH)
+	@ ./$(CTAGS_BENCH) -f bench.tags *.[ch]
+	@ ./vstrbench $(MICROBENCH_INPUT)
+	@ ./kwbench $(MICROBENCH_INPUT)
+	@ ./rebench $(MICROBENCH_INPUT)
+	@ ./sortbench bench.tags
+	@ ./findbench bench.tags
+
+.SECONDEXPANSION:
+$(MICROBENCH_PROGS): %: bench/%.c bench/benchutil.c bench/benchutil.h $$(%_OBJS)
+	$(CC) -I. -Ibench -DHAVE_CONFIG_H $(CFLAGS) -o $@ bench/$*.c bench/benchutil.c $($*_OBJS)
+
+clean-bench:
+	rm -rf $(BENCH_CORPUS) bench.tags $(MICROBENCH_PROGS)
+
+# vi:ts=4 sw=4
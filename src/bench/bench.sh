@@ -0,0 +1,87 @@
+#!/bin/sh
+#	$Id$
+#
+#	Copyright (c) 2026, amigazen project
+#
+#	This source code is released for free distribution under the terms of the
+#	GNU General Public License.
+#
+#	Benchmark driver for ctags. Runs ctags over each synthetic corpus made by
+#	gencorpus.sh, keeping the fastest of several runs, and prints one line
+#	per corpus in a fixed format suitable for comparing builds with diff(1).
+#	Timings are taken from the --profile summary written by ctags itself.
+#
+#	Usage: bench.sh ctags [corpus-directory]
+#
+#	Environment:
+#	    BENCH_RUNS	   number of runs of each corpus [3]
+#	    BENCH_SCALE	   size of the corpora generated [1]
+#	    BENCH_OPTIONS  additional options given to ctags
+#	    BENCH_CORPORA  corpora to run [all]
+
+CTAGS=${1:?usage: bench.sh ctags [corpus-directory]}
+CORPUS=${2:-bench.corpus}
+RUNS=${BENCH_RUNS:-3}
+SCALE=${BENCH_SCALE:-1}
+SCRIPTS=`dirname "$0"`
+TMP=${TMPDIR:-/tmp}/ctags-bench.$$
+
+trap 'rm -rf "$TMP"' 0 1 2 15
+mkdir -p "$TMP" || exit 1
+
+sh "$SCRIPTS/gencorpus.sh" "$CORPUS" "$SCALE" || exit 1
+CORPORA=${BENCH_CORPORA:-`cd "$CORPUS" && ls`}
+
+# Peak resident set size is only available with GNU time.
+TIME=
+if /usr/bin/time -f %M -o "$TMP/rss" true >/dev/null 2>&1; then
+	TIME="/usr/bin/time -f %M -o $TMP/rss"
+fi
+
+printf "%-16s %8s %6s %8s %8s %8s %10s %9s %7s %7s %7s %7s %7s\n" \
+	corpus MB files tags seconds MB/s tags/s maxrss_kB \
+	walk detect parse write sort
+
+for corpus in $CORPORA; do
+	best=
+	run=0
+	while [ $run -lt $RUNS ]; do
+		run=`expr $run + 1`
+		rm -f "$TMP/rss"
+		if ! $TIME "$CTAGS" $BENCH_OPTIONS -R --profile="$TMP/profile.json" \
+				-f "$TMP/tags" "$CORPUS/$corpus" 2>"$TMP/errors"; then
+			echo "$corpus: ctags failed:" >&2
+			cat "$TMP/errors" >&2
+			exit 1
+		fi
+		rss=-
+		[ -s "$TMP/rss" ] && rss=`tail -1 "$TMP/rss"`
+		result=`awk -v corpus="$corpus" -v rss="$rss" '
+			function value(name,  s) {
+				s = $0
+				sub (".*\"" name "\": *", "", s)
+				sub ("[,} ].*", "", s)
+				return s + 0
+			}
+			/"total":/ { bytes = value("bytes"); files = value("files"); tags = value("tags") }
+			/"phases":/ {
+				walk = value("walk"); detect = value("detect"); parse = value("parse")
+				write = value("write"); sort = value("sort")
+			}
+			END {
+				seconds = walk + detect + parse + write + sort
+				mb = bytes / 1048576
+				printf ("%.6f %-16s %8.2f %6d %8d %8.3f %8.2f %10.0f %9s %7.3f %7.3f %7.3f %7.3f %7.3f\n",
+					seconds, corpus, mb, files, tags, seconds,
+					seconds > 0 ? mb / seconds : 0,
+					seconds > 0 ? tags / seconds : 0,
+					rss, walk, detect, parse, write, sort)
+			}' "$TMP/profile.json"`
+		if [ -z "$best" ] || \
+		   awk -v a="$result" -v b="$best" 'BEGIN { split (a, x, " "); split (b, y, " "); exit !(x[1] < y[1]) }'
+		then
+			best=$result
+		fi
+	done
+	echo "$best" | cut -d' ' -f2-
+done
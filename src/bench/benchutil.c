@@ -0,0 +1,113 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions shared by the microbenchmarks: timing,
+*   loading of input files and reporting of results. Every microbenchmark
+*   prints one line per measurement in the same fixed format, so that the
+*   output of two builds may be compared with diff(1).
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_TIME_H
+# include <time.h>
+#endif
+
+#include "routines.h"
+#include "vstring.h"
+#include "benchutil.h"
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern double benchClock (void)
+{
+#if defined (CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+#else
+    return (double) clock () / CLOCKS_PER_SEC;
+#endif
+}
+
+extern void benchReadLines (const char *const fileName, benchLines *const input)
+{
+    FILE *const fp = fopen (fileName, "r");
+    vString *const line = vStringNew ();
+    size_t max = 0;
+    int c;
+
+    if (fp == NULL)
+	error (FATAL | PERROR, "cannot open \"%s\"", fileName);
+    input->lines = NULL;
+    input->count = 0;
+    input->bytes = 0;
+    do
+    {
+	c = getc (fp);
+	if (c == '\n'  ||  (c == EOF  &&  vStringLength (line) > 0))
+	{
+	    vStringTerminate (line);
+	    if (input->count == max)
+	    {
+		max = max == 0 ? 1024 : 2 * max;
+		input->lines = xRealloc (input->lines, max, char *);
+	    }
+	    input->lines [input->count++] = eStrdup (vStringValue (line));
+	    input->bytes += vStringLength (line);
+	    vStringClear (line);
+	}
+	else if (c != EOF)
+	    vStringPut (line, c);
+    } while (c != EOF);
+    fclose (fp);
+    vStringDelete (line);
+    if (input->count == 0)
+	error (FATAL, "\"%s\" is empty", fileName);
+}
+
+extern void benchFreeLines (benchLines *const input)
+{
+    size_t i;
+    for (i = 0  ;  i < input->count  ;  ++i)
+	eFree (input->lines [i]);
+    if (input->lines != NULL)
+	eFree (input->lines);
+    input->lines = NULL;
+    input->count = 0;
+}
+
+/*  Returns the number of repetitions requested by a "-n count" option, which
+ *  must precede the other arguments.
+ */
+extern unsigned int benchRepeat (const int argc, char **const argv,
+				 const unsigned int defaultCount)
+{
+    unsigned int count = defaultCount;
+    if (argc > 2  &&  strcmp (argv [1], "-n") == 0)
+	count = (unsigned int) atoi (argv [2]);
+    return count > 0 ? count : 1;
+}
+
+extern void benchReport (const char *const name, const unsigned long operations,
+			 const double seconds, const char *const note)
+{
+    printf ("%-32s %12lu ops %10.3f ms %10.2f ns/op%s%s\n", name, operations,
+	    seconds * 1e3, operations > 0 ? seconds * 1e9 / operations : 0.0,
+	    note == NULL ? "" : "  ", note == NULL ? "" : note);
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
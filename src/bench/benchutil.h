@@ -0,0 +1,41 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to benchutil.c, shared by the microbenchmarks.
+*/
+#ifndef _BENCHUTIL_H
+#define _BENCHUTIL_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stddef.h>
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sBenchLines {
+    char **lines;		/* lines of input, without newlines */
+    size_t count;		/* number of lines */
+    size_t bytes;		/* total length of lines */
+} benchLines;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern double benchClock (void);
+extern void benchReadLines (const char *const fileName, benchLines *const input);
+extern void benchFreeLines (benchLines *const input);
+extern unsigned int benchRepeat (const int argc, char **const argv, const unsigned int defaultCount);
+extern void benchReport (const char *const name, const unsigned long operations, const double seconds, const char *const note);
+
+#endif	/* _BENCHUTIL_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,81 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmark of tag file searching: looking up every tag name of a tag
+*   file with the binary search of the readtags library.
+*
+*   Usage: findbench [-n count] tagfile
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "routines.h"
+#include "readtags.h"
+#include "benchutil.h"
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void benchFind (const char *const fileName, const benchLines *const input,
+		       const unsigned int repeat)
+{
+    tagFileInfo info;
+    tagFile *const file = tagsOpen (fileName, &info);
+    unsigned long operations = 0, found = 0;
+    double start;
+    unsigned int r;
+    size_t i;
+    char note [64];
+
+    if (file == NULL)
+	error (FATAL | PERROR, "cannot open tag file \"%s\"", fileName);
+    start = benchClock ();
+    for (r = 0  ;  r < repeat  ;  ++r)
+	for (i = 0  ;  i < input->count  ;  ++i)
+	{
+	    const char *const line = input->lines [i];
+	    const size_t length = strcspn (line, "\t");
+	    char name [256];
+	    tagEntry entry;
+
+	    if (line [0] == '!'  ||  length >= sizeof (name))
+		continue;
+	    memcpy (name, line, length);
+	    name [length] = '\0';
+	    if (tagsFind (file, &entry, name, TAG_FULLMATCH) == TagSuccess)
+		++found;
+	    ++operations;
+	}
+    sprintf (note, "%lu found", found / repeat);
+    benchReport ("tagsFind", operations, benchClock () - start, note);
+    tagsClose (file);
+}
+
+extern int main (int argc, char **argv)
+{
+    const unsigned int repeat = benchRepeat (argc, argv, 5);
+    const char *const fileName = argv [argc - 1];
+    benchLines input;
+
+    setExecutableName (argv [0]);
+    if (argc < 2)
+	error (FATAL, "usage: findbench [-n count] tagfile");
+    benchReadLines (fileName, &input);
+    benchFind (fileName, &input, repeat);
+    benchFreeLines (&input);
+    return 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
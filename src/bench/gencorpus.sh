@@ -0,0 +1,139 @@
+#!/bin/sh
+#	$Id$
+#
+#	Copyright (c) 2026, amigazen project
+#
+#	This source code is released for free distribution under the terms of the
+#	GNU General Public License.
+#
+#	Generates deterministic synthetic source corpora for benchmarking ctags.
+#	The same scale always produces byte-identical files, so that results may
+#	be compared between builds.
+#
+#	Usage: gencorpus.sh directory [scale]
+
+DIR=${1:?usage: gencorpus.sh directory [scale]}
+SCALE=${2:-1}
+
+if [ -f "$DIR/.scale" ] && [ "`cat "$DIR/.scale"`" = "$SCALE" ]; then
+	exit 0
+fi
+rm -rf "$DIR"
+mkdir -p "$DIR/c-headers" "$DIR/cxx-nested" "$DIR/fortran-fixed" \
+	"$DIR/sql" "$DIR/cobol" || exit 1
+
+# Large C headers: macros, enumerations, structures and prototypes.
+awk -v scale="$SCALE" -v dir="$DIR/c-headers" 'BEGIN {
+	for (f = 0; f < 20 * scale; f++) {
+		out = sprintf ("%s/header%03d.h", dir, f)
+		printf ("#ifndef HEADER%03d_H\n#define HEADER%03d_H\n\n", f, f) > out
+		for (i = 0; i < 400; i++) {
+			printf ("#define H%d_CONSTANT_%d\t(%d << %d)\n", f, i, i, i % 16) > out
+			printf ("#define H%d_MACRO_%d(a, b)\t((a) * %d + (b))\n", f, i, i) > out
+		}
+		for (i = 0; i < 40; i++) {
+			printf ("\ntypedef enum eH%dEnum%d {\n", f, i) > out
+			for (j = 0; j < 12; j++)
+				printf ("    H%d_E%d_VALUE_%d,\n", f, i, j) > out
+			printf ("    H%d_E%d_COUNT\n} h%dEnum%d;\n", f, i, f, i) > out
+			printf ("\ntypedef struct sH%dRecord%d {\n", f, i) > out
+			for (j = 0; j < 8; j++)
+				printf ("    unsigned long field%d;\t/* field %d */\n", j, j) > out
+			printf ("    struct sH%dRecord%d *next;\n} h%dRecord%d;\n", f, i, f, i) > out
+		}
+		printf ("\n") > out
+		for (i = 0; i < 600; i++)
+			printf ("extern int h%d_function_%d (const h%dRecord%d *const record, unsigned int flags, const char *name);\n", f, i, f, i % 40) > out
+		printf ("\n#endif\n") > out
+		close (out)
+	}
+}'
+
+# Deeply nested C++: namespaces containing classes containing classes.
+awk -v scale="$SCALE" -v dir="$DIR/cxx-nested" '
+function spaces(n,  s) { s = ""; while (n-- > 0) s = s " "; return s }
+BEGIN {
+	for (f = 0; f < 20 * scale; f++) {
+		out = sprintf ("%s/nested%03d.cpp", dir, f)
+		for (n = 0; n < 8; n++)
+			printf ("%snamespace ns%d_%d {\n", spaces(n * 2), f, n) > out
+		for (c = 0; c < 30; c++) {
+			indent = 16
+			for (d = 0; d < 6; d++) {
+				printf ("%sclass C%d_%d : public Base%d {\n%spublic:\n", spaces(indent), c, d, d, spaces(indent)) > out
+				for (m = 0; m < 5; m++)
+					printf ("%s    virtual int method%d (int x, const char *s) const { return x + %d; }\n", spaces(indent), m, m) > out
+				printf ("%s    template <typename T> T convert%d (const T &value) { return value; }\n", spaces(indent), d) > out
+				indent += 4
+			}
+			for (d = 5; d >= 0; d--) {
+				indent -= 4
+				printf ("%s};\n", spaces(indent)) > out
+			}
+			printf ("int C%d_0::C%d_1::method%d_outside (int y) { return y; }\n", c, c, c) > out
+		}
+		for (n = 7; n >= 0; n--)
+			printf ("%s}\n", spaces(n * 2)) > out
+		close (out)
+	}
+}'
+
+# Long Fortran fixed-form files, with comment and continuation lines.
+awk -v scale="$SCALE" -v dir="$DIR/fortran-fixed" 'BEGIN {
+	for (f = 0; f < 10 * scale; f++) {
+		out = sprintf ("%s/fixed%03d.f", dir, f)
+		printf ("      PROGRAM MAIN%d\n      CALL SUB%d0(1, 2)\n      END\n", f, f) > out
+		for (s = 0; s < 200; s++) {
+			printf ("C\nC     Subroutine %d of file %d\nC\n", s, f) > out
+			printf ("      SUBROUTINE SUB%d%d(IARG, JARG)\n", f, s) > out
+			printf ("      INTEGER IARG, JARG, K%d\n", s) > out
+			printf ("      REAL*8 WORK%d(100)\n", s) > out
+			printf ("      COMMON /BLK%d/ WORK%d\n", s, s) > out
+			printf ("      DO 10 K%d = 1, 100\n", s) > out
+			printf ("         WORK%d(K%d) = IARG * K%d +\n     &              JARG * 2\n", s, s, s) > out
+			printf ("   10 CONTINUE\n      RETURN\n      END\n") > out
+			printf ("      INTEGER FUNCTION IFUN%d%d(X)\n      INTEGER X\n", f, s) > out
+			printf ("      IFUN%d%d = X * %d\n      RETURN\n      END\n", f, s, s) > out
+		}
+		close (out)
+	}
+}'
+
+# Huge SQL files: schema definitions followed by bulk data statements.
+awk -v scale="$SCALE" -v dir="$DIR/sql" 'BEGIN {
+	for (f = 0; f < 4 * scale; f++) {
+		out = sprintf ("%s/dump%03d.sql", dir, f)
+		for (t = 0; t < 50; t++) {
+			printf ("CREATE TABLE table%d_%d (\n    id INTEGER PRIMARY KEY,\n    name VARCHAR(80),\n    value NUMERIC(10,2)\n);\n", f, t) > out
+			printf ("CREATE INDEX index%d_%d ON table%d_%d (name);\n", f, t, f, t) > out
+			printf ("CREATE OR REPLACE PROCEDURE proc%d_%d (p IN INTEGER) IS\nBEGIN\n    UPDATE table%d_%d SET value = value + p;\nEND proc%d_%d;\n/\n", f, t, f, t, f, t) > out
+		}
+		for (r = 0; r < 20000; r++)
+			printf ("INSERT INTO table%d_%d VALUES (%d, %cname %d; (begin) end%c, %d.%02d);\n", f, r % 50, r, 39, r, 39, r, r % 100) > out
+		close (out)
+	}
+}'
+
+# COBOL, which is parsed entirely with regular expressions.
+awk -v scale="$SCALE" -v dir="$DIR/cobol" 'BEGIN {
+	for (f = 0; f < 10 * scale; f++) {
+		out = sprintf ("%s/program%03d.cbl", dir, f)
+		printf ("       IDENTIFICATION DIVISION.\n       PROGRAM-ID. PROG%d.\n", f) > out
+		printf ("       DATA DIVISION.\n       FILE SECTION.\n       FD INPUT-FILE%d.\n", f) > out
+		printf ("       WORKING-STORAGE SECTION.\n") > out
+		for (g = 0; g < 150; g++) {
+			printf ("       01 GROUP-%d-%d.\n", f, g) > out
+			for (i = 0; i < 8; i++)
+				printf ("          05 ITEM-%d-%d-%d PIC X(%d) VALUE SPACES.\n", f, g, i, i + 1) > out
+		}
+		printf ("       PROCEDURE DIVISION.\n") > out
+		for (p = 0; p < 400; p++) {
+			printf ("       PARA-%d-%d.\n", f, p) > out
+			printf ("           MOVE ITEM-%d-%d-0 TO ITEM-%d-%d-1\n", f, p % 150, f, p % 150) > out
+			printf ("           PERFORM PARA-%d-%d.\n", f, (p + 1) % 400) > out
+		}
+		close (out)
+	}
+}'
+
+echo "$SCALE" > "$DIR/.scale"
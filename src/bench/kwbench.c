@@ -0,0 +1,150 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmark of the keyword hash: lookupKeyword() for every identifier
+*   of a source file against keyword tables for several languages, together
+*   with the distribution of the hash chains.
+*
+*   Usage: kwbench [-n count] file
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+
+#include "keyword.h"
+#include "routines.h"
+#include "vstring.h"
+#include "benchutil.h"
+
+/*
+*   MACROS
+*/
+#define LANGUAGES	4	/* keyword tables installed, as for C, C++, ... */
+
+/*
+*   DATA DEFINITIONS
+*/
+
+/*  A union of the C, C++, C# and Java keyword tables.
+ */
+static const char *const Keywords [] = {
+    "__attribute__", "abstract", "asm", "auto", "bool", "boolean", "break",
+    "byte", "case", "catch", "char", "class", "const", "const_cast",
+    "continue", "default", "delete", "do", "double", "dynamic_cast", "else",
+    "enum", "explicit", "extends", "extern", "final", "finally", "float",
+    "for", "friend", "goto", "if", "implements", "import", "inline", "int",
+    "interface", "long", "mutable", "namespace", "native", "new", "operator",
+    "package", "private", "protected", "public", "register",
+    "reinterpret_cast", "return", "short", "signed", "sizeof", "static",
+    "static_cast", "struct", "switch", "synchronized", "template", "this",
+    "throw", "throws", "transient", "try", "typedef", "typeid", "typename",
+    "union", "unsigned", "using", "virtual", "void", "volatile", "while",
+    NULL
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void installKeywords (void)
+{
+    int language, i;
+    for (language = 0  ;  language < LANGUAGES  ;  ++language)
+	for (i = 0  ;  Keywords [i] != NULL  ;  ++i)
+	    addKeyword (Keywords [i], (langType) language, i + 1);
+}
+
+/*  Splits the input into identifiers, as a parser's lexer would.
+ */
+static char **findIdentifiers (const benchLines *const input, size_t *const count)
+{
+    vString *const word = vStringNew ();
+    char **words = NULL;
+    size_t max = 0;
+    size_t i;
+
+    *count = 0;
+    for (i = 0  ;  i < input->count  ;  ++i)
+    {
+	const char *p = input->lines [i];
+	while (*p != '\0')
+	{
+	    if (! isalpha ((int) *p)  &&  *p != '_')
+		++p;
+	    else
+	    {
+		vStringClear (word);
+		while (isalnum ((int) *p)  ||  *p == '_')
+		{
+		    vStringPut (word, *p);	/* a macro: no side effects */
+		    ++p;
+		}
+		vStringTerminate (word);
+		if (*count == max)
+		{
+		    max = max == 0 ? 4096 : 2 * max;
+		    words = xRealloc (words, max, char *);
+		}
+		words [(*count)++] = eStrdup (vStringValue (word));
+	    }
+	}
+    }
+    vStringDelete (word);
+    return words;
+}
+
+extern int main (int argc, char **argv)
+{
+    const unsigned int repeat = benchRepeat (argc, argv, 20);
+    benchLines input;
+    char **words;
+    size_t count, i;
+    unsigned long operations = 0, hits = 0;
+    unsigned long keywords;
+    unsigned int used, longest;
+    unsigned int r;
+    double start, seconds;
+    char note [96];
+
+    setExecutableName (argv [0]);
+    if (argc < 2)
+	error (FATAL, "usage: kwbench [-n count] file");
+    benchReadLines (argv [argc - 1], &input);
+    installKeywords ();
+    words = findIdentifiers (&input, &count);
+
+    start = benchClock ();
+    for (r = 0  ;  r < repeat  ;  ++r)
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+	    if (lookupKeyword (words [i], (langType) (i % LANGUAGES)) != 0)
+		++hits;
+	    ++operations;
+	}
+    seconds = benchClock () - start;
+    getKeywordTableStatistics (&keywords, &used, &longest);
+    sprintf (note, "%lu%% hits; %lu keywords in %u buckets, longest chain %u",
+	    operations > 0 ? 100 * hits / operations : 0, keywords, used, longest);
+    benchReport ("lookupKeyword", operations, seconds, note);
+
+    for (i = 0  ;  i < count  ;  ++i)
+	eFree (words [i]);
+    if (words != NULL)
+	eFree (words);
+    freeKeywordTable ();
+    benchFreeLines (&input);
+    return 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
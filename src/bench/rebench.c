@@ -0,0 +1,90 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmark of the regular expression engine: the cost per line of
+*   RegExec() for each of the patterns used by the regex based parsers.
+*
+*   Usage: rebench [-n count] file
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "routines.h"
+#include "regexp_internal.h"
+#include "benchutil.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+static const struct sPattern {
+    const char *name;
+    const char *pattern;
+} Patterns [] = {
+    { "cobol data",	"^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)[ \t]+(BLANK|OCCURS|IS|JUST|PIC|REDEFINES|RENAMES|SIGN|SYNC|USAGE|VALUE)" },
+    { "cobol file",	"^[ \t]*[FSR]D[ \t]+([A-Z0-9][A-Z0-9-]*)\\." },
+    { "cobol group",	"^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)\\." },
+    { "cobol paragraph","^[ \t]*([A-Z0-9][A-Z0-9-]*)\\." },
+    { "cobol program",	"^[ \t]*PROGRAM-ID\\.[ \t]+([A-Z0-9][A-Z0-9-]*)\\." },
+    { "cobol section",	"^[ \t]*([A-Z0-9][A-Z0-9-]*)[ \t]+SECTION\\." },
+    { "javascript function", "^[ \t]*function[ \t]*([A-Za-z0-9_]+)[ \t]*\\(" },
+    { "rexx subroutine","^([A-Za-z0-9@#$\\.!?_]+)[ \t]*:" },
+    { "slang define",	"^.*define[ \t]+([A-Z_][A-Z0-9_]*)[^;]*$" },
+    { "yacc label",	"^([A-Za-z][A-Za-z_0-9]+)[ \t]*:" },
+};
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+extern int main (int argc, char **argv)
+{
+    const unsigned int repeat = benchRepeat (argc, argv, 20);
+    const size_t count = sizeof (Patterns) / sizeof (Patterns [0]);
+    benchLines input;
+    size_t p;
+
+    setExecutableName (argv [0]);
+    if (argc < 2)
+	error (FATAL, "usage: rebench [-n count] file");
+    benchReadLines (argv [argc - 1], &input);
+
+    for (p = 0  ;  p < count  ;  ++p)
+    {
+	regexp *const prog = RegComp ((char *) Patterns [p].pattern);
+	unsigned long operations = 0, matches = 0;
+	unsigned int r;
+	double start;
+	size_t i;
+	char name [64], note [64];
+
+	if (prog == NULL)
+	    error (FATAL, "cannot compile pattern for %s", Patterns [p].name);
+	start = benchClock ();
+	for (r = 0  ;  r < repeat  ;  ++r)
+	    for (i = 0  ;  i < input.count  ;  ++i)
+	    {
+		if (RegExec (prog, input.lines [i]) == 0)	/* 0 on match */
+		    ++matches;
+		++operations;
+	    }
+	sprintf (name, "RegExec (%s)", Patterns [p].name);
+	sprintf (note, "%lu matches", matches / repeat);
+	benchReport (name, operations, benchClock () - start, note);
+	RegFree (prog);
+    }
+    benchFreeLines (&input);
+    return 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
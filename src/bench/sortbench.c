@@ -0,0 +1,136 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmark of tag sorting: sorting the lines of a tag file with
+*   sortTagBuffer() of sort.c, for both --sort=yes and --sort=foldcase. This
+*   exercises the keyed bucket sort which sortTagBuffer() shares with
+*   internalSortTags(), the latter not being driven directly because it
+*   rewrites the tag file in place and is compiled only with INTERNAL_SORT.
+*
+*   Usage: sortbench [-n count] tagfile
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+
+#include "entry.h"
+#include "main.h"
+#define OPTION_WRITE
+#include "options.h"
+#include "read.h"
+#include "routines.h"
+#include "sort.h"
+#include "vstring.h"
+#include "benchutil.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+optionValues Option;		/* read by sortTagBuffer () */
+#ifndef EXTERNAL_SORT
+tagFile TagFile;		/* read by internalSortTags () */
+#endif
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Stand-ins for the parts of ctags to which sort.o refers in order to merge
+ *  or sort a tag file, none of which is reached by sortTagBuffer().
+ */
+static void notReached (const char *const name)
+{
+    error (FATAL, "%s () called by sortbench", name);
+}
+
+extern boolean isDestinationStdout (void)
+{
+    notReached ("isDestinationStdout");
+    return FALSE;
+}
+
+extern boolean isTagFile (const char *const filename __unused__)
+{
+    notReached ("isTagFile");
+    return FALSE;
+}
+
+extern const char *tagFileName (void)
+{
+    notReached ("tagFileName");
+    return NULL;
+}
+
+extern void setDefaultTagFileName (void)
+{
+    notReached ("setDefaultTagFileName");
+}
+
+extern char *readLine (vString *const vLine __unused__,
+		       FILE *const fp __unused__)
+{
+    notReached ("readLine");
+    return NULL;
+}
+
+extern void verbose (const char *const format __unused__, ...)
+{
+}
+
+static void benchSort (const benchLines *const input, const unsigned int repeat,
+		       const char *const name, const sortType sorted)
+{
+    vString *const lines = vStringNew ();
+    vString *const buffer = vStringNew ();
+    double seconds = 0.0;
+    unsigned int r;
+    size_t i;
+    char note [64];
+
+    for (i = 0  ;  i < input->count  ;  ++i)
+    {
+	vStringCatS (lines, input->lines [i]);
+	vStringPut (lines, '\n');
+    }
+    vStringTerminate (lines);
+    Option.sorted = sorted;
+    for (r = 0  ;  r < repeat  ;  ++r)
+    {
+	double start;
+	vStringCopy (buffer, lines);
+	start = benchClock ();
+	sortTagBuffer (buffer);
+	seconds += benchClock () - start;
+    }
+    sprintf (note, "%lu lines", (unsigned long) input->count);
+    benchReport (name, (unsigned long) input->count * repeat, seconds, note);
+    vStringDelete (buffer);
+    vStringDelete (lines);
+}
+
+extern int main (int argc, char **argv)
+{
+    const unsigned int repeat = benchRepeat (argc, argv, 5);
+    const char *const fileName = argv [argc - 1];
+    benchLines input;
+
+    setExecutableName (argv [0]);
+    if (argc < 2)
+	error (FATAL, "usage: sortbench [-n count] tagfile");
+    benchReadLines (fileName, &input);
+    benchSort (&input, repeat, "sortTagBuffer", SO_SORTED);
+    benchSort (&input, repeat, "sortTagBuffer (foldcase)", SO_FOLDSORTED);
+    benchFreeLines (&input);
+    return 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,151 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   Microbenchmark of vString operations: building strings one character at
+*   a time with vStringPut(), appending with vStringCatS() and copying with
+*   vStringNCopyS(), together with the number of buffer resizes incurred.
+*
+*   Usage: vstrbench [-n count] file
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "routines.h"
+#include "vstring.h"
+#include "benchutil.h"
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void benchPutNew (const benchLines *const input, const unsigned int repeat)
+{
+    unsigned long operations = 0, resizes = 0;
+    double start = benchClock ();
+    unsigned int r;
+    size_t i;
+    char note [64];
+
+    for (r = 0  ;  r < repeat  ;  ++r)
+	for (i = 0  ;  i < input->count  ;  ++i)
+	{
+	    vString *const s = vStringNew ();
+	    const char *p;
+	    size_t size = vStringSize (s);
+
+	    for (p = input->lines [i]  ;  *p != '\0'  ;  ++p)
+	    {
+		vStringPut (s, *p);
+		if (vStringSize (s) != size)
+		{
+		    size = vStringSize (s);
+		    ++resizes;
+		}
+	    }
+	    vStringTerminate (s);
+	    operations += strlen (input->lines [i]);
+	    vStringDelete (s);
+	}
+    sprintf (note, "%lu resizes", resizes);
+    benchReport ("vStringPut (new string)", operations, benchClock () - start, note);
+}
+
+static void benchPutReused (const benchLines *const input, const unsigned int repeat)
+{
+    vString *const s = vStringNew ();
+    unsigned long operations = 0;
+    double start = benchClock ();
+    unsigned int r;
+    size_t i;
+
+    for (r = 0  ;  r < repeat  ;  ++r)
+	for (i = 0  ;  i < input->count  ;  ++i)
+	{
+	    const char *p;
+	    vStringClear (s);
+	    for (p = input->lines [i]  ;  *p != '\0'  ;  ++p)
+		vStringPut (s, *p);
+	    vStringTerminate (s);
+	    operations += strlen (input->lines [i]);
+	}
+    benchReport ("vStringPut (reused string)", operations, benchClock () - start, NULL);
+    vStringDelete (s);
+}
+
+static void benchCatS (const benchLines *const input, const unsigned int repeat)
+{
+    unsigned long operations = 0, resizes = 0;
+    double start = benchClock ();
+    unsigned int r;
+    char note [64];
+
+    for (r = 0  ;  r < repeat  ;  ++r)
+    {
+	vString *const s = vStringNew ();
+	size_t size = vStringSize (s);
+	size_t i;
+
+	for (i = 0  ;  i < input->count  ;  ++i)
+	{
+	    vStringCatS (s, input->lines [i]);
+	    if (vStringSize (s) != size)
+	    {
+		size = vStringSize (s);
+		++resizes;
+	    }
+	    ++operations;
+	}
+	vStringDelete (s);
+    }
+    sprintf (note, "%lu resizes", resizes);
+    benchReport ("vStringCatS (whole file)", operations, benchClock () - start, note);
+}
+
+static void benchNCopyS (const benchLines *const input, const unsigned int repeat)
+{
+    vString *const s = vStringNew ();
+    unsigned long operations = 0;
+    double start = benchClock ();
+    unsigned int r;
+    size_t i;
+
+    for (r = 0  ;  r < repeat  ;  ++r)
+	for (i = 0  ;  i < input->count  ;  ++i)
+	{
+	    const char *const line = input->lines [i];
+	    vStringNCopyS (s, line, strlen (line) / 2);
+	    ++operations;
+	}
+    benchReport ("vStringNCopyS (half line)", operations, benchClock () - start, NULL);
+    vStringDelete (s);
+}
+
+extern int main (int argc, char **argv)
+{
+    const unsigned int repeat = benchRepeat (argc, argv, 20);
+    benchLines input;
+
+    setExecutableName (argv [0]);
+    if (argc < 2)
+	error (FATAL, "usage: vstrbench [-n count] file");
+    benchReadLines (argv [argc - 1], &input);
+    benchPutNew (&input, repeat);
+    benchPutReused (&input, repeat);
+    benchCatS (&input, repeat);
+    benchNCopyS (&input, repeat);
+    benchFreeLines (&input);
+    return 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
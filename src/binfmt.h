@@ -0,0 +1,79 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released into the public domain.
+*
+*   Defines the layout of the binary tag database written by bintags.c
+*   (--output-format=bin) and read by readtags.c.
+*
+*   All numbers are unsigned 32-bit little-endian words, so that the file
+*   may be used in place (e.g. mapped into memory) on any host. Strings are
+*   held once each in a pool of NUL-terminated strings and referred to by
+*   their offset within the pool; offset 0 is always the empty string.
+*
+*	header		BIN_HEADER_SIZE bytes
+*	records		one BIN_RECORD_SIZE record per tag, in the order made
+*	fields		BIN_FIELD_SIZE (key, value) pairs, referred to by records
+*	index		one word per tag: record numbers in order of tag name
+*	pool		strings
+*/
+#ifndef _BINFMT_H
+#define _BINFMT_H
+
+/*
+*   MACROS
+*/
+#define BIN_MAGIC		"CTAGSBIN"
+#define BIN_MAGIC_LENGTH	8
+#define BIN_VERSION		1
+
+/*  Offsets of words within header.
+ */
+#define BIN_H_VERSION		8
+#define BIN_H_FLAGS		12
+#define BIN_H_TAG_COUNT		16	/* number of records */
+#define BIN_H_RECORDS		20	/* file offset of records */
+#define BIN_H_FIELD_COUNT	24	/* number of field pairs */
+#define BIN_H_FIELDS		28	/* file offset of fields */
+#define BIN_H_INDEX_COUNT	32	/* number of index entries */
+#define BIN_H_INDEX		36	/* file offset of index */
+#define BIN_H_POOL_SIZE		40	/* size of pool in bytes */
+#define BIN_H_POOL		44	/* file offset of pool */
+#define BIN_H_PROGRAM_NAME	48	/* pool offsets of program details */
+#define BIN_H_PROGRAM_AUTHOR	52
+#define BIN_H_PROGRAM_URL	56
+#define BIN_H_PROGRAM_VERSION	60
+#define BIN_HEADER_SIZE		64
+
+/*  Header flags.
+ */
+#define BIN_SORTED		0x1	/* records iterated in index order */
+#define BIN_FOLDCASE		0x2	/* index ordered ignoring case */
+
+/*  Offsets of words within each record.
+ */
+#define BIN_R_NAME		0	/* pool offset of tag name */
+#define BIN_R_FILE		4	/* pool offset of source file name */
+#define BIN_R_ADDRESS		8	/* pool offset of pattern or line number */
+#define BIN_R_LINE		12	/* line number of tag */
+#define BIN_R_KIND		16	/* pool offset of kind (0 if none) */
+#define BIN_R_FLAGS		20
+#define BIN_R_FIELD		24	/* number of first field pair */
+#define BIN_R_FIELD_COUNT	28	/* number of field pairs */
+#define BIN_RECORD_SIZE		32
+
+/*  Record flags.
+ */
+#define BIN_FILE_SCOPE		0x1	/* tag is of file-limited scope */
+
+/*  Offsets of words within each field pair.
+ */
+#define BIN_F_KEY		0
+#define BIN_F_VALUE		4
+#define BIN_FIELD_SIZE		8
+
+#endif	/* _BINFMT_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
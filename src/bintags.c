@@ -0,0 +1,361 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for writing a binary tag database (the
+*   --output-format=bin option), whose layout is described in binfmt.h. Tags
+*   are held in memory as fixed-size records of interned string identifiers
+*   until the tag file is closed, when the pool of strings is laid out.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>	/* to declare qsort () */
+
+#include "bintags.h"
+#include "binfmt.h"
+#include "ctags.h"
+#include "debug.h"
+#include "intern.h"
+#include "options.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define MAX_WORD	0xffffffffUL
+#define UNASSIGNED	MAX_WORD	/* string not yet placed in pool */
+
+/*
+*   DATA DECLARATIONS
+*/
+
+typedef struct sBinaryRecord {
+    unsigned int name;		/* interned strings ... */
+    unsigned int file;
+    unsigned int address;
+    unsigned int kind;		/* ... (0 if none) */
+    unsigned long lineNumber;
+    unsigned long flags;
+    unsigned long field;	/* number of first field pair */
+    unsigned long fieldCount;
+} binaryRecord;
+
+/*
+*   DATA DEFINITIONS
+*/
+static binaryRecord *Records = NULL;
+static unsigned long RecordCount = 0;
+static unsigned long RecordSpace = 0;
+
+static unsigned int *Fields = NULL;	/* key and value of each pair */
+static unsigned long FieldCount = 0;
+static unsigned long FieldSpace = 0;
+
+/*  The pool is laid out when the tag file is written.
+ */
+static unsigned long *PoolOffsets = NULL;	/* by string identifier */
+static unsigned int *PoolStrings = NULL;	/* strings in order of offset */
+static unsigned int PoolCount = 0;
+static unsigned long PoolLength = 0;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static void addField (binaryRecord *const record,
+		      const char *const key, const char *const value)
+{
+    if (FieldCount == FieldSpace)
+    {
+	FieldSpace = (FieldSpace == 0) ? 1024 : 2 * FieldSpace;
+	Fields = xRealloc (Fields, 2 * FieldSpace, unsigned int);
+    }
+    Fields [2 * FieldCount]     = internString (key);
+    Fields [2 * FieldCount + 1] = internString (value);
+    ++FieldCount;
+    ++record->fieldCount;
+}
+
+/*  Holds a tag until the tag file is written. The address is the pattern
+ *  or line number which would be written to a ctags file.
+ */
+extern void captureBinaryTag (const tagEntryInfo *const tag,
+			      const char *const address)
+{
+    binaryRecord *record;
+
+    if (RecordCount == RecordSpace)
+    {
+	RecordSpace = (RecordSpace == 0) ? 1024 : 2 * RecordSpace;
+	Records = xRealloc (Records, RecordSpace, binaryRecord);
+    }
+    record = &Records [RecordCount++];
+    record->name       = internString (tag->name);
+    record->file       = internString (tag->sourceFileName);
+    record->address    = internString (address);
+    record->lineNumber = tag->lineNumber;
+    record->kind       = 0;
+    record->flags      = 0;
+    record->field      = FieldCount;
+    record->fieldCount = 0;
+
+    /*  The kind, file scope and line number have places in the record;
+     *  other fields are stored as key and value pairs.
+     */
+    if (Option.tagFileFormat > 1)
+    {
+	extensionFieldList fields;
+	unsigned int i;
+
+	getExtensionFields (tag, &fields);
+	for (i = 0  ;  i < fields.count  ;  ++i)
+	{
+	    const char *const key = fields.item [i].key;
+	    const char *const value = fields.item [i].value;
+
+	    if (key == NULL  ||  strcmp (key, "kind") == 0)
+		record->kind = internString (value);
+	    else if (strcmp (key, "file") == 0)
+		record->flags |= BIN_FILE_SCOPE;
+	    else if (strcmp (key, "line") != 0)
+		addField (record, key, value);
+	}
+    }
+}
+
+/*  Discards all but the first "count" tags (i.e. when a file is parsed
+ *  again). Strings added to the pool are kept.
+ */
+extern void truncateBinaryTags (const unsigned long count)
+{
+    Assert (count <= RecordCount);
+    RecordCount = count;
+    if (count == 0)
+	FieldCount = 0;
+    else
+	FieldCount = Records [count - 1].field + Records [count - 1].fieldCount;
+}
+
+static int compareRecords (const void *const one, const void *const two)
+{
+    const binaryRecord *const r1 = &Records [*(const unsigned long *) one];
+    const binaryRecord *const r2 = &Records [*(const unsigned long *) two];
+    int (*const compare) (const char *, const char *) =
+	    (Option.sorted == SO_FOLDSORTED) ? struppercmp : strcmp;
+    int result;
+
+    result = compare (internedString (r1->name), internedString (r2->name));
+    if (result == 0)
+	result = compare (internedString (r1->file),
+			  internedString (r2->file));
+    if (result == 0)
+	result = compare (internedString (r1->address),
+			  internedString (r2->address));
+    if (result == 0)
+	result = (r1 < r2) ? -1 : (r1 > r2);
+    return result;
+}
+
+/*  Would the two tags be written as identical lines to a ctags file?
+ */
+static boolean isDuplicate (const binaryRecord *const r1,
+			    const binaryRecord *const r2)
+{
+    boolean result = (boolean) (
+	    r1->name == r2->name  &&  r1->file == r2->file  &&
+	    r1->address == r2->address  &&  r1->kind == r2->kind  &&
+	    r1->flags == r2->flags  &&  r1->fieldCount == r2->fieldCount  &&
+	    (r1->lineNumber == r2->lineNumber  ||
+	     ! Option.extensionFields.lineNumber));
+    unsigned long i;
+
+    for (i = 0  ;  result  &&  i < 2 * r1->fieldCount  ;  ++i)
+	result = (boolean) (Fields [2 * r1->field + i] ==
+			    Fields [2 * r2->field + i]);
+    return result;
+}
+
+/*  Makes the index of records in order of name, omitting duplicates if the
+ *  tags are sorted. Returns the number of entries.
+ */
+static unsigned long makeIndex (unsigned long *const index)
+{
+    unsigned long count = RecordCount;
+    unsigned long i;
+
+    for (i = 0  ;  i < RecordCount  ;  ++i)
+	index [i] = i;
+    qsort (index, (size_t) RecordCount, sizeof (unsigned long),
+	   compareRecords);
+    if (Option.sorted != SO_UNSORTED  &&  RecordCount > 0)
+    {
+	count = 1;
+	for (i = 1  ;  i < RecordCount  ;  ++i)
+	    if (! isDuplicate (&Records [index [count - 1]],
+			       &Records [index [i]]))
+		index [count++] = index [i];
+    }
+    return count;
+}
+
+/*  Returns the offset in the pool of an interned string, placing it in the
+ *  pool if it is not already there. Offset 0 is the empty string.
+ */
+static unsigned long poolOffset (const unsigned int id)
+{
+    unsigned long offset = 0;
+
+    if (id != 0  &&  *internedString (id) != '\0')
+    {
+	if (PoolOffsets [id] == UNASSIGNED)
+	{
+	    const size_t length = strlen (internedString (id)) + 1;
+
+	    if (length > MAX_WORD - PoolLength)
+		error (FATAL, "too many strings for binary tag file");
+	    PoolOffsets [id] = PoolLength;
+	    PoolStrings [PoolCount++] = id;
+	    PoolLength += length;
+	}
+	offset = PoolOffsets [id];
+    }
+    return offset;
+}
+
+/*  Lays out the pool, holding only those strings used by the tags.
+ */
+static void makePool (void)
+{
+    const unsigned int count = internedCount ();
+    unsigned long i;
+
+    PoolOffsets = xMalloc (count, unsigned long);
+    PoolStrings = xMalloc (count, unsigned int);
+    for (i = 0  ;  i < count  ;  ++i)
+	PoolOffsets [i] = UNASSIGNED;
+    PoolCount = 0;
+    PoolLength = 1;		/* the empty string */
+    for (i = 0  ;  i < RecordCount  ;  ++i)
+    {
+	poolOffset (Records [i].name);
+	poolOffset (Records [i].file);
+	poolOffset (Records [i].address);
+	poolOffset (Records [i].kind);
+    }
+    for (i = 0  ;  i < 2 * FieldCount  ;  ++i)
+	poolOffset (Fields [i]);
+}
+
+static void putWord (FILE *const fp, const unsigned long word)
+{
+    putc ((int) (word & 0xff), fp);
+    putc ((int) ((word >> 8) & 0xff), fp);
+    putc ((int) ((word >> 16) & 0xff), fp);
+    putc ((int) ((word >> 24) & 0xff), fp);
+}
+
+/*  Writes the binary tag database from the tags held.
+ */
+extern void writeBinaryTagFile (const char *const name)
+{
+    unsigned long *const index = xMalloc (RecordCount + 1, unsigned long);
+    const unsigned long indexCount = makeIndex (index);
+    const unsigned long records = BIN_HEADER_SIZE;
+    const unsigned long fields = records + RecordCount * BIN_RECORD_SIZE;
+    const unsigned long indexStart = fields + FieldCount * BIN_FIELD_SIZE;
+    const unsigned long pool = indexStart + indexCount * 4;
+    const unsigned int programName    = internString (PROGRAM_NAME);
+    const unsigned int programAuthor  = internString (AUTHOR_NAME);
+    const unsigned int programUrl     = internString (PROGRAM_URL);
+    const unsigned int programVersion = internString (PROGRAM_VERSION);
+    unsigned long flags = 0;
+    unsigned long i;
+    FILE *fp;
+
+    if (Option.sorted != SO_UNSORTED)
+	flags |= BIN_SORTED;
+    if (Option.sorted == SO_FOLDSORTED)
+	flags |= BIN_FOLDCASE;
+    makePool ();
+    if (PoolLength > MAX_WORD - pool)
+	error (FATAL, "too many tags for binary tag file");
+
+    fp = fopen (name, "wb");
+    if (fp == NULL)
+	error (FATAL | PERROR, "cannot open tag file \"%s\"", name);
+    fwrite (BIN_MAGIC, (size_t) 1, (size_t) BIN_MAGIC_LENGTH, fp);
+    putWord (fp, BIN_VERSION);
+    putWord (fp, flags);
+    putWord (fp, RecordCount);
+    putWord (fp, records);
+    putWord (fp, FieldCount);
+    putWord (fp, fields);
+    putWord (fp, indexCount);
+    putWord (fp, indexStart);
+    putWord (fp, PoolLength);
+    putWord (fp, pool);
+    putWord (fp, poolOffset (programName));
+    putWord (fp, poolOffset (programAuthor));
+    putWord (fp, poolOffset (programUrl));
+    putWord (fp, poolOffset (programVersion));
+
+    for (i = 0  ;  i < RecordCount  ;  ++i)
+    {
+	const binaryRecord *const record = &Records [i];
+
+	putWord (fp, poolOffset (record->name));
+	putWord (fp, poolOffset (record->file));
+	putWord (fp, poolOffset (record->address));
+	putWord (fp, record->lineNumber);
+	putWord (fp, poolOffset (record->kind));
+	putWord (fp, record->flags);
+	putWord (fp, record->field);
+	putWord (fp, record->fieldCount);
+    }
+    for (i = 0  ;  i < 2 * FieldCount  ;  ++i)
+	putWord (fp, poolOffset (Fields [i]));
+    for (i = 0  ;  i < indexCount  ;  ++i)
+	putWord (fp, index [i]);
+    putc ('\0', fp);		/* the empty string */
+    for (i = 0  ;  i < PoolCount  ;  ++i)
+    {
+	const char *const string = internedString (PoolStrings [i]);
+	fwrite (string, (size_t) 1, strlen (string) + 1, fp);
+    }
+
+    if (ferror (fp)  ||  fclose (fp) != 0)
+	error (FATAL | PERROR, "cannot write tag file \"%s\"", name);
+    eFree (index);
+}
+
+extern void freeBinaryTagResources (void)
+{
+    if (Records != NULL)
+	eFree (Records);
+    if (Fields != NULL)
+	eFree (Fields);
+    if (PoolOffsets != NULL)
+	eFree (PoolOffsets);
+    if (PoolStrings != NULL)
+	eFree (PoolStrings);
+    Records = NULL;
+    Fields = NULL;
+    PoolOffsets = NULL;
+    PoolStrings = NULL;
+    RecordCount = RecordSpace = 0;
+    FieldCount = FieldSpace = 0;
+    PoolCount = 0;
+    PoolLength = 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,31 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to bintags.c
+*/
+#ifndef _BINTAGS_H
+#define _BINTAGS_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include "entry.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void captureBinaryTag (const tagEntryInfo *const tag, const char *const address);
+extern void truncateBinaryTags (const unsigned long count);
+extern void writeBinaryTagFile (const char *const name);
+extern void freeBinaryTagResources (void);
+
+#endif	/* _BINTAGS_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -46,6 +46,13 @@
 
 #define isHighChar(c)		((unsigned char)(c) >= 0xc0)
 
+/*  Signatures are only recorded when they will actually be written out,
+ *  which they always are in JSON output.
+ */
+#define isSignatureWanted()	(boolean) (Option.outputFormat == OF_JSON || \
+		    (Option.extensionFields.signature && \
+		    Option.tagFileFormat > 1  &&  ! Option.etags  && ! Option.xref))
+
 /*
 *   DATA DECLARATIONS
 */
@@ -1289,8 +1296,13 @@ static void skipToMatch (const char *const pair)
     int matchLevel = 1;
     int c = '\0';
 
-    while (matchLevel > 0  &&  (c = skipToNonWhite ()) != EOF)
+    while (matchLevel > 0)
     {
+	if (! CollectingSignature)
+	    cppSkipToCharacter (pair);
+	c = skipToNonWhite ();
+	if (c == EOF)
+	    break;
 	if (CollectingSignature)
 	    vStringPut (Signature, c);
 	if (c == begin)
@@ -1931,14 +1943,16 @@ static int parseParens (statementInfo *const st, parenInfo *const info)
     boolean firstChar = TRUE;
     int nextChar = '\0';
 
-    CollectingSignature = TRUE;
+    CollectingSignature = isSignatureWanted ();
     vStringClear (Signature);
-    vStringPut (Signature, '(');
+    if (CollectingSignature)
+	vStringPut (Signature, '(');
     info->parameterCount = 1;
     do
     {
 	int c = skipToNonWhite ();
-	vStringPut (Signature, c);
+	if (CollectingSignature)
+	    vStringPut (Signature, c);
 
 	switch (c)
 	{
@@ -1982,13 +1996,15 @@ static int parseParens (statementInfo *const st, parenInfo *const info)
 
 	    case '[':
 		info->isKnrParamList = FALSE;
-		vStringPut (Signature, c);
+		if (CollectingSignature)
+		    vStringPut (Signature, c);
 		skipToMatch ("[]");
 		break;
 
 	    case '<':
 		info->isKnrParamList = FALSE;
-		vStringPut (Signature, c);
+		if (CollectingSignature)
+		    vStringPut (Signature, c);
 		skipToMatch ("<>");
 		break;
 
@@ -8,32 +8,399 @@
 *
 *   This module contains functions for generating tags for COBOL language
 *   files.
+*
+*   Each line is read once and classified by its first few words. Lines in
+*   fixed source form have a sequence area (columns 1-6), an indicator area
+*   (column 7) and end at column 72; lines in free source form have neither.
+*   The regular expressions formerly used for COBOL may still be selected by
+*   the --cobol-regex option.
 */
 
 /*
 *   INCLUDE FILES
 */
 #include "general.h"	/* must always come first */
+
+#include <ctype.h>
+#include <string.h>
+
+#include "options.h"
 #include "parse.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define PREFIX_SIZE		16384	/* bytes examined to detect source form */
+#define SEQUENCE_LENGTH		6	/* columns of sequence area */
+#define INDICATOR_COLUMN	6	/* offset of indicator area */
+#define CODE_LENGTH		72	/* columns ending fixed form line */
+
+#define isNameChar(c)		(isalnum ((int) (c))  ||  (c) == '-')
+#define isBlank(c)		((c) == ' '  ||  (c) == '\t')
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef enum {
+    K_DATA, K_FILE, K_GROUP, K_PARAGRAPH, K_PROGRAM, K_SECTION
+} cobolKind;
+
+/*  A word of a line, which is not terminated.
+ */
+typedef struct sWord {
+    const char *start;
+    size_t length;
+} word;
+
+/*
+*   DATA DEFINITIONS
+*/
+static kindOption CobolKinds [] = {
+    { TRUE, 'd', "data",      "data items"                       },
+    { TRUE, 'f', "file",      "file descriptions (FD, SD, RD)"   },
+    { TRUE, 'g', "group",     "group items"                      },
+    { TRUE, 'p', "paragraph", "paragraphs"                       },
+    { TRUE, 'P', "program",   "program ids"                      },
+    { TRUE, 's', "section",   "sections"                         }
+};
+
+/*  Words which may follow the name of an elementary data item. As for the
+ *  regular expressions, these need only begin the word (e.g. "PICTURE").
+ */
+static const char *const DataClauses [] = {
+    "BLANK", "OCCURS", "IS", "JUST", "PIC", "REDEFINES", "RENAMES", "SIGN",
+    "SYNC", "USAGE", "VALUE", NULL
+};
+
+static char Prefix [PREFIX_SIZE];	/* start of file, to detect source form */
+static boolean FreeSourceForm;
+static boolean RegexInstalled = FALSE;
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
+/*
+*   Regular expression parsing (--cobol-regex)
+*/
+
+static void makeRegexTag (const char *const line,
+			  const regexMatch *const matches,
+			  const unsigned int count, const cobolKind kind)
+{
+    if (count > 1)
+    {
+	vString *const name = vStringNew ();
+	vStringNCopyS (name, line + matches [1].start, matches [1].length);
+	makeSimpleTag (name, CobolKinds, kind);
+	vStringDelete (name);
+    }
+}
+
+static void dataCallback (const char *line, const regexMatch *matches,
+			  unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_DATA);
+}
+
+static void fileCallback (const char *line, const regexMatch *matches,
+			  unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_FILE);
+}
+
+static void groupCallback (const char *line, const regexMatch *matches,
+			   unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_GROUP);
+}
+
+static void paragraphCallback (const char *line, const regexMatch *matches,
+			       unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_PARAGRAPH);
+}
+
+static void programCallback (const char *line, const regexMatch *matches,
+			     unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_PROGRAM);
+}
+
+static void sectionCallback (const char *line, const regexMatch *matches,
+			     unsigned int count)
+{
+    makeRegexTag (line, matches, count, K_SECTION);
+}
+
+/*  The patterns are installed only when first needed, since the option is
+ *  not known when the parsers are initialized. Their tags are made with the
+ *  kinds of the native parser, so that --cobol-kinds applies to both.
+ */
 static void installCobolRegex (const langType language)
 {
-   addTagRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)[ \t]+(BLANK|OCCURS|IS|JUST|PIC|REDEFINES|RENAMES|SIGN|SYNC|USAGE|VALUE)",
-	"\\1", "d,data,data items", "i");
-   addTagRegex (language, "^[ \t]*[FSR]D[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-	"\\1", "f,file,file descriptions (FD, SD, RD)", "i");
-   addTagRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-	"\\1", "g,group,group items", "i");
-   addTagRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)\\.",
-	"\\1", "p,paragraph,paragraphs", "i");
-   addTagRegex (language, "^[ \t]*PROGRAM-ID\\.[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
-	"\\1", "P,program,program ids", "i");
-   addTagRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)[ \t]+SECTION\\.",
-	"\\1", "s,section,sections", "i");
+   addCallbackRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)[ \t]+(BLANK|OCCURS|IS|JUST|PIC|REDEFINES|RENAMES|SIGN|SYNC|USAGE|VALUE)",
+	"i", dataCallback);
+   addCallbackRegex (language, "^[ \t]*[FSR]D[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
+	"i", fileCallback);
+   addCallbackRegex (language, "^[ \t]*[0-9]+[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
+	"i", groupCallback);
+   addCallbackRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)\\.",
+	"i", paragraphCallback);
+   addCallbackRegex (language, "^[ \t]*PROGRAM-ID\\.[ \t]+([A-Z0-9][A-Z0-9-]*)\\.",
+	"i", programCallback);
+   addCallbackRegex (language, "^[ \t]*([A-Z0-9][A-Z0-9-]*)[ \t]+SECTION\\.",
+	"i", sectionCallback);
+}
+
+/*
+*   Native parsing
+*/
+
+static boolean isWord (const word *const w, const char *const s)
+{
+    return (boolean) (w->length == strlen (s)  &&
+		      strnuppercmp (w->start, s, w->length) == 0);
+}
+
+static boolean wordBegins (const word *const w, const char *const s)
+{
+    const size_t length = strlen (s);
+    return (boolean) (w->length >= length  &&
+		      strnuppercmp (w->start, s, length) == 0);
+}
+
+static boolean isLevelNumber (const word *const w)
+{
+    size_t i;
+    for (i = 0  ;  i < w->length  &&  isdigit ((int) w->start [i])  ;  ++i)
+	;
+    return (boolean) (w->length > 0  &&  i == w->length);
+}
+
+/*  Reads the word beginning at `cp', which must start with a letter or
+ *  digit, returning a pointer past it.
+ */
+static const char *readWord (const char *cp, const char *const end,
+			     word *const w)
+{
+    w->start = cp;
+    if (cp < end  &&  isalnum ((int) *cp))
+    {
+	while (cp < end  &&  isNameChar (*cp))
+	    ++cp;
+    }
+    w->length = (size_t) (cp - w->start);
+    return cp;
+}
+
+static const char *skipBlanks (const char *cp, const char *const end)
+{
+    while (cp < end  &&  isBlank (*cp))
+	++cp;
+    return cp;
+}
+
+static void makeWordTag (const word *const w, const cobolKind kind)
+{
+    if (CobolKinds [kind].enabled)
+    {
+	vString *const name = vStringNew ();
+	vStringNCopyS (name, w->start, w->length);
+	makeSimpleTag (name, CobolKinds, kind);
+	vStringDelete (name);
+    }
+}
+
+/*  Notes a ">>SOURCE FORMAT IS FREE" or "$SET SOURCEFORMAT"FREE"" directive
+ *  (or the FIXED forms) changing the source form of the following lines.
+ */
+static void readDirective (const char *cp, const char *const end)
+{
+    while (cp < end)
+    {
+	if (! isalpha ((int) *cp))
+	    ++cp;
+	else
+	{
+	    word w;
+	    cp = readWord (cp, end, &w);
+	    if (isWord (&w, "FREE"))
+		FreeSourceForm = TRUE;
+	    else if (isWord (&w, "FIXED"))
+		FreeSourceForm = FALSE;
+	}
+    }
+}
+
+/*  Classifies the code of a line, from `cp' to `end', making any tags it
+ *  defines. The tests are those of the regular expressions, so that a
+ *  line may define more than one tag (e.g. "PROGRAM-ID. NAME.").
+ */
+static void classifyCode (const char *cp, const char *const end)
+{
+    word first, second, third;
+
+    cp = skipBlanks (cp, end);
+    if (cp < end  &&  *cp == '>'  &&  cp + 1 < end  &&  cp [1] == '>')
+	readDirective (cp + 2, end);
+    else if (cp < end  &&  isalnum ((int) *cp))
+    {
+	cp = readWord (cp, end, &first);
+	if (cp < end  &&  *cp == '.')
+	{
+	    makeWordTag (&first, K_PARAGRAPH);
+	    if (isWord (&first, "PROGRAM-ID"))
+	    {
+		cp = skipBlanks (cp + 1, end);
+		cp = readWord (cp, end, &second);
+		if (second.length > 0  &&  cp < end  &&  *cp == '.')
+		    makeWordTag (&second, K_PROGRAM);
+	    }
+	}
+	else if (cp < end  &&  isBlank (*cp))
+	{
+	    cp = skipBlanks (cp, end);
+	    cp = readWord (cp, end, &second);
+	    if (second.length == 0)
+		;
+	    else if (cp < end  &&  *cp == '.')
+	    {
+		if (isLevelNumber (&first))
+		    makeWordTag (&second, K_GROUP);
+		else if (isWord (&first, "FD")  ||  isWord (&first, "SD")  ||
+			 isWord (&first, "RD"))
+		    makeWordTag (&second, K_FILE);
+		if (isWord (&second, "SECTION"))
+		    makeWordTag (&first, K_SECTION);
+	    }
+	    else if (cp < end  &&  isBlank (*cp))
+	    {
+		cp = skipBlanks (cp, end);
+		readWord (cp, end, &third);
+		if (isLevelNumber (&first))
+		{
+		    int i;
+		    for (i = 0  ;  DataClauses [i] != NULL  ;  ++i)
+		    {
+			if (wordBegins (&third, DataClauses [i]))
+			{
+			    makeWordTag (&second, K_DATA);
+			    break;
+			}
+		    }
+		}
+	    }
+	}
+    }
+}
+
+/*  Would the line (which does not include its newline) be out of place in
+ *  fixed source form? This is so of a line which has a letter in its
+ *  sequence area and text in its indicator area which is not an indicator,
+ *  as when a free form line begins with a word in its first column.
+ */
+static boolean isFreeFormLine (const char *const line, const size_t length)
+{
+    boolean result = FALSE;
+    boolean letter = FALSE;
+    size_t column;
+
+    for (column = 0  ;  column < length  &&  column < SEQUENCE_LENGTH  ;  ++column)
+    {
+	if (line [column] == '\t')
+	    break;
+	else if (isalpha ((int) line [column]))
+	    letter = TRUE;
+    }
+    if (letter  &&  column == INDICATOR_COLUMN  &&  column < length)
+	result = (boolean) (strchr (" \t*/-Dd$", line [column]) == NULL);
+    return result;
+}
+
+/*  Examines the start of the file for any line in free source form. A file
+ *  showing none is read in fixed source form, unless a directive says
+ *  otherwise.
+ */
+static boolean isFreeSourceFormPrefix (void)
+{
+    const size_t length = filePeek (Prefix, sizeof (Prefix));
+    boolean result = FALSE;
+    size_t start = 0;
+    size_t i;
+
+    for (i = 0  ;  i < length  &&  ! result  ;  ++i)
+    {
+	if (Prefix [i] == '\n'  ||  Prefix [i] == '\r')
+	{
+	    result = isFreeFormLine (Prefix + start, i - start);
+	    start = i + 1;
+	}
+    }
+    return result;
+}
+
+static void classifyLine (const char *const line)
+{
+    const size_t length = strlen (line);
+    const char *end = line + length;
+
+    while (end > line  &&  (end [-1] == '\n'  ||  end [-1] == '\r'))
+	--end;
+    if (FreeSourceForm)
+    {
+	const char *const cp = skipBlanks (line, end);
+	if (! (cp + 1 < end  &&  cp [0] == '*'  &&  cp [1] == '>'))
+	    classifyCode (cp, end);
+    }
+    else
+    {
+	const char *cp = line;
+	size_t column = 0;
+
+	/*  A tab in the sequence area takes the place of the indicator area.
+	 */
+	while (cp < end  &&  column < INDICATOR_COLUMN  &&  *cp != '\t')
+	    ++cp, ++column;
+	if (cp < end  &&  *cp == '\t')
+	    classifyCode (cp + 1, end);
+	else if (cp < end)
+	{
+	    const int indicator = *cp++;
+	    if (end > line + CODE_LENGTH)
+		end = line + CODE_LENGTH;
+	    if (indicator == '$')
+		readDirective (cp, end);
+	    else if (strchr ("*/-", indicator) == NULL)
+		classifyCode (cp, end);
+	}
+    }
+}
+
+static void findCobolTags (void)
+{
+    const unsigned char *line;
+
+    if (Option.cobolRegex)
+    {
+	if (! RegexInstalled)
+	{
+	    installCobolRegex (getSourceLanguage ());
+	    RegexInstalled = TRUE;
+	}
+	findRegexTags ();
+    }
+    else
+    {
+	FreeSourceForm = isFreeSourceFormPrefix ();
+	if (FreeSourceForm)
+	    verbose ("%s: parsing as free source form\n", getInputFileName ());
+	while ((line = fileReadLine ()) != NULL)
+	    classifyLine ((const char *) line);
+    }
 }
 
 extern parserDefinition* CobolParser ()
@@ -41,9 +408,10 @@ extern parserDefinition* CobolParser ()
     static const char *const extensions [] = {
 	    "cbl", "cob", "CBL", "COB", NULL };
     parserDefinition* def = parserNew ("Cobol");
+    def->kinds      = CobolKinds;
+    def->kindCount  = KIND_COUNT (CobolKinds);
     def->extensions = extensions;
-    def->initialize = installCobolRegex;
-    def->regex      = TRUE;
+    def->parser     = findCobolTags;
     return def;
 }
 
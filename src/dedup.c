@@ -0,0 +1,363 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for recognizing source files whose contents
+*   are identical to those of a file already parsed during this run (e.g.
+*   vendored copies of the same header), and for reusing the tags generated
+*   for the first such file instead of parsing the copy again.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "debug.h"
+#include "dedup.h"
+#include "entry.h"
+#include "intern.h"
+#include "main.h"
+#include "options.h"
+#include "read.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define HASH_EXPONENT	10
+
+#define FNV_OFFSET_BASIS	2166136261UL
+#define FNV_PRIME		16777619UL
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Describes a file which has been parsed, together with copies of the tags
+ *  generated for it.
+ */
+typedef struct sParsedFile {
+    struct sParsedFile *next;
+    char *fileName;		/* name of file originally parsed */
+    langType language;		/* language used to parse it */
+    unsigned long size;		/* size of file contents */
+    unsigned long hash;		/* hash of file contents */
+    unsigned long lines;	/* number of lines, for totals */
+    unsigned int count;		/* number of tags recorded */
+    unsigned int max;		/* allocated size of `tags' */
+    tagEntryInfo *tags;		/* tags generated for file */
+} parsedFile;
+
+enum { BufferSize = 4096 };
+
+/*
+*   DATA DEFINITIONS
+*/
+static const unsigned int TableSize = 1 << HASH_EXPONENT;
+static parsedFile *HashTable [1 << HASH_EXPONENT];
+static parsedFile *Current = NULL;	/* file whose tags are being recorded */
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static char *copyString (const char *const string)
+{
+    char *result = NULL;
+    if (string != NULL)
+	result = eStrdup (string);
+    return result;
+}
+
+static void freeString (const char *const string)
+{
+    if (string != NULL)
+	eFree ((char *) string);
+}
+
+/*  Strings which recur across tags (kind and scope names, access and the
+ *  like) are interned rather than copied, and so are not freed here.
+ */
+static void freeTagCopy (tagEntryInfo *const tag)
+{
+    freeString (tag->name);
+    freeString (tag->extensionFields.signature);
+}
+
+static void clearParsedFile (parsedFile *const parsed)
+{
+    unsigned int i;
+    for (i = 0  ;  i < parsed->count  ;  ++i)
+	freeTagCopy (&parsed->tags [i]);
+    parsed->count = 0;
+}
+
+static void deleteParsedFile (parsedFile *const parsed)
+{
+    clearParsedFile (parsed);
+    if (parsed->tags != NULL)
+	eFree (parsed->tags);
+    eFree (parsed->fileName);
+    eFree (parsed);
+}
+
+/*  Computes a hash (32-bit FNV-1a) and the size of the contents of a file.
+ */
+static boolean hashFileContents (const char *const fileName,
+				 unsigned long *const pSize,
+				 unsigned long *const pHash)
+{
+    boolean result = FALSE;
+    FILE *const fp = fopen (fileName, "rb");
+    if (fp != NULL)
+    {
+	unsigned char *const buffer = xMalloc (BufferSize, unsigned char);
+	unsigned long hash = FNV_OFFSET_BASIS;
+	unsigned long size = 0;
+	size_t numRead;
+
+	while ((numRead = fread (buffer, (size_t) 1, (size_t) BufferSize, fp)) > 0)
+	{
+	    size_t i;
+	    for (i = 0  ;  i < numRead  ;  ++i)
+	    {
+		hash ^= buffer [i];
+		hash = (hash * FNV_PRIME) & 0xffffffffUL;
+	    }
+	    size += numRead;
+	}
+	result = (boolean) (! ferror (fp));
+	eFree (buffer);
+	fclose (fp);
+	*pSize = size;
+	*pHash = hash;
+    }
+    return result;
+}
+
+/*  Confirms a hash match by comparing the two files byte for byte.
+ */
+static boolean isSameContents (const char *const name1, const char *const name2)
+{
+    boolean result = FALSE;
+    FILE *const fp1 = fopen (name1, "rb");
+    FILE *const fp2 = fopen (name2, "rb");
+
+    if (fp1 != NULL  &&  fp2 != NULL)
+    {
+	char *const buffer1 = xMalloc (BufferSize, char);
+	char *const buffer2 = xMalloc (BufferSize, char);
+	size_t numRead1, numRead2;
+
+	do
+	{
+	    numRead1 = fread (buffer1, (size_t) 1, (size_t) BufferSize, fp1);
+	    numRead2 = fread (buffer2, (size_t) 1, (size_t) BufferSize, fp2);
+	    result = (boolean) (numRead1 == numRead2  &&
+			memcmp (buffer1, buffer2, numRead1) == 0);
+	} while (result  &&  numRead1 == (size_t) BufferSize);
+	eFree (buffer1);
+	eFree (buffer2);
+    }
+    if (fp1 != NULL)
+	fclose (fp1);
+    if (fp2 != NULL)
+	fclose (fp2);
+    return result;
+}
+
+/*  The base file name is part of the key because it determines whether a
+ *  file is treated as a header and is the name of any file tag; a few
+ *  parsers also special-case particular file names.
+ */
+static parsedFile *findParsedFile (const char *const fileName,
+				   const langType language,
+				   const unsigned long size,
+				   const unsigned long hash)
+{
+    parsedFile *parsed = HashTable [hash & (TableSize - 1)];
+    while (parsed != NULL)
+    {
+	if (parsed->language == language  &&  parsed->size == size  &&
+	    parsed->hash == hash  &&
+	    strcmp (baseFilename (parsed->fileName), baseFilename (fileName)) == 0  &&
+	    isSameContents (parsed->fileName, fileName))
+	    break;
+	parsed = parsed->next;
+    }
+    return parsed;
+}
+
+static parsedFile *newParsedFile (const char *const fileName,
+				  const langType language,
+				  const unsigned long size,
+				  const unsigned long hash)
+{
+    parsedFile *const parsed = xMalloc (1, parsedFile);
+    parsed->next     = NULL;
+    parsed->fileName = eStrdup (fileName);
+    parsed->language = language;
+    parsed->size     = size;
+    parsed->hash     = hash;
+    parsed->lines    = 0;
+    parsed->count    = 0;
+    parsed->max      = 0;
+    parsed->tags     = NULL;
+    return parsed;
+}
+
+/*  Generates the tags for a file from the tags recorded for an identical
+ *  one. The source file is still opened, because the tag writers read the
+ *  source line for each tag from it.
+ */
+static void reuseParsedFile (const parsedFile *const parsed,
+			     const char *const fileName,
+			     const langType language)
+{
+    verbose ("reusing tags of %s for %s\n", parsed->fileName, fileName);
+    if (fileOpen (fileName, language))
+    {
+	unsigned int i;
+
+	if (Option.etags)
+	    beginEtagsFile ();
+
+	for (i = 0  ;  i < parsed->count  ;  ++i)
+	{
+	    tagEntryInfo tag;
+	    tag = parsed->tags [i];
+	    tag.sourceFileName = getSourceFileTagPath ();
+	    makeTagEntry (&tag);
+	}
+
+	if (Option.etags)
+	    endEtagsFile (getSourceFileTagPath ());
+
+	fileClose ();
+	if (Option.printTotals)
+	    addTotals (0, parsed->lines, 0L);
+    }
+}
+
+/*  Called before parsing a file. Returns TRUE if tags for the file were
+ *  generated from an earlier file with the same contents; otherwise starts
+ *  recording the tags generated by parsing this one. Files processed with
+ *  #line directives are never shared, since their tags may name other
+ *  source files.
+ */
+extern boolean dedupParseFile (const char *const fileName,
+			       const langType language)
+{
+    boolean reused = FALSE;
+    unsigned long size, hash;
+
+    Assert (Current == NULL);
+    if (! Option.lineDirectives  &&
+	hashFileContents (fileName, &size, &hash))
+    {
+	parsedFile *const parsed = findParsedFile (fileName, language, size, hash);
+	if (parsed != NULL)
+	{
+	    reuseParsedFile (parsed, fileName, language);
+	    reused = TRUE;
+	}
+	else
+	    Current = newParsedFile (fileName, language, size, hash);
+    }
+    return reused;
+}
+
+extern void dedupCaptureTag (const tagEntryInfo *const tag)
+{
+    if (Current != NULL)
+    {
+	enum { incrementalIncrease = 32 };
+	tagEntryInfo *copy;
+
+	if (Current->count == Current->max)
+	{
+	    Current->max += incrementalIncrease;
+	    Current->tags = xRealloc (Current->tags, Current->max, tagEntryInfo);
+	}
+	copy = &Current->tags [Current->count++];
+	*copy = *tag;
+	copy->sourceFileName = NULL;
+	copy->name     = copyString (tag->name);
+	copy->kindName = internStringCopy (tag->kindName);
+	copy->extensionFields.access =
+		internStringCopy (tag->extensionFields.access);
+	copy->extensionFields.fileScope =
+		internStringCopy (tag->extensionFields.fileScope);
+	copy->extensionFields.implementation =
+		internStringCopy (tag->extensionFields.implementation);
+	copy->extensionFields.inheritance =
+		internStringCopy (tag->extensionFields.inheritance);
+	copy->extensionFields.scope [0] =
+		internStringCopy (tag->extensionFields.scope [0]);
+	copy->extensionFields.scope [1] =
+		internStringCopy (tag->extensionFields.scope [1]);
+	copy->extensionFields.signature =
+		copyString (tag->extensionFields.signature);
+    }
+}
+
+/*  Discards the tags recorded so far, when a parser retries a file.
+ */
+extern void dedupRestartFile (void)
+{
+    if (Current != NULL)
+	clearParsedFile (Current);
+}
+
+extern void dedupEndFile (void)
+{
+    if (Current != NULL)
+    {
+	const unsigned long lineNumber = getInputLineNumber ();
+	const unsigned int i = Current->hash & (TableSize - 1);
+
+	Current->lines = lineNumber > 0 ? lineNumber - 1L : 0L;
+	Current->next = HashTable [i];
+	HashTable [i] = Current;
+	Current = NULL;
+    }
+}
+
+/*  Forgets all files recorded so far. Called whenever options are changed
+ *  between files, since these may change the tags generated.
+ */
+extern void dedupForget (void)
+{
+    unsigned int i;
+    for (i = 0  ;  i < TableSize  ;  ++i)
+    {
+	parsedFile *parsed = HashTable [i];
+	while (parsed != NULL)
+	{
+	    parsedFile *const next = parsed->next;
+	    deleteParsedFile (parsed);
+	    parsed = next;
+	}
+	HashTable [i] = NULL;
+    }
+}
+
+extern void freeDedupResources (void)
+{
+    if (Current != NULL)
+    {
+	deleteParsedFile (Current);
+	Current = NULL;
+    }
+    dedupForget ();
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,34 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to dedup.c
+*/
+#ifndef _DEDUP_H
+#define _DEDUP_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include "entry.h"
+#include "parse.h"
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern boolean dedupParseFile (const char *const fileName, const langType language);
+extern void dedupCaptureTag (const tagEntryInfo *const tag);
+extern void dedupRestartFile (void);
+extern void dedupEndFile (void);
+extern void dedupForget (void);
+extern void freeDedupResources (void);
+
+#endif	/* _DEDUP_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
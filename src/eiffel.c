@@ -25,6 +25,7 @@
 
 #include "debug.h"
 #include "keyword.h"
+#include "lexer.h"
 #include "routines.h"
 #include "vstring.h"
 #ifndef TYPE_REFERENCE_TOOL
@@ -37,12 +38,13 @@
 /*
 *   MACROS
 */
-#define isident(c)		(isalnum(c) || (c) == '_')
 #define isFreeOperatorChar(c)	((c) == '@' || (c) == '#' || \
 				 (c) == '|' || (c) == '&')
 #define isType(token,t)		(boolean) ((token)->type == (t))
 #define isKeyword(token,k)	(boolean) ((token)->keyword == (k))
 
+#define EIFFEL_OPERATOR	0x10	/* character of a free operator */
+
 /*
 *   DATA DECLARATIONS
 */
@@ -117,6 +119,8 @@ typedef struct sTokenInfo {
 
 static langType Lang_eiffel;
 
+static lexClassTable EiffelClasses;
+
 #ifdef TYPE_REFERENCE_TOOL
 
 static const char *FileName;
@@ -272,6 +276,27 @@ static int fileUngetc (c)
     return ungetc (c, File);
 }
 
+static void fileSkipToCharacter (const char *const __unused__ stops)
+{
+    /*  characters are left to be read one at a time by fileGetc () */
+}
+
+static int fileGetSpan (vString *const string, const unsigned char *const table,
+			const int mask)
+{
+    int c = fileGetc ();
+
+    while (lexIsClass (table, c, mask))
+    {
+	if (string != NULL)
+	    vStringPut (string, c);
+	c = fileGetc ();
+    }
+    if (string != NULL)
+	vStringTerminate (string);
+    return c;
+}
+
 extern char *readLine (vString *const vLine, FILE *const fp)
 {
     return NULL;
@@ -365,10 +390,14 @@ static void makeEiffelLocalTag (tokenInfo *const token)
 
 static int skipToCharacter (const int c)
 {
+    char stops [2];
     int d;
 
+    stops [0] = (char) c;
+    stops [1] = '\0';
     do
     {
+	fileSkipToCharacter (stops);
 	d = fileGetc ();
     } while (d != EOF  &&  d != c);
 
@@ -570,45 +599,27 @@ static void parseString (vString *const string)
  */
 static void parseIdentifier (vString *const string, const int firstChar)
 {
-    int c = firstChar;
-
-    do
-    {
-	vStringPut (string, c);
-	c = fileGetc ();
-    } while (isident (c));
+    int c;
 
-    vStringTerminate (string);
+    vStringPut (string, firstChar);
+    c = fileGetSpan (string, EiffelClasses, LEX_IDENT);
     if (!isspace (c))
 	fileUngetc (c);		/* unget non-identifier character */
 }
 
 static void parseFreeOperator (vString *const string, const int firstChar)
 {
-    int c = firstChar;
-
-    do
-    {
-	vStringPut (string, c);
-	c = fileGetc ();
-    } while (c > ' ');
+    int c;
 
-    vStringTerminate (string);
+    vStringPut (string, firstChar);
+    c = fileGetSpan (string, EiffelClasses, EIFFEL_OPERATOR);
     if (!isspace (c))
 	fileUngetc (c);		/* unget non-identifier character */
 }
 
 static keywordId analyzeToken (vString *const name)
 {
-    static vString *keyword = NULL;
-    keywordId id;
-
-    if (keyword == NULL)
-	keyword = vStringNew ();
-    vStringCopyToLower (keyword, name);
-    id = (keywordId) lookupKeyword (vStringValue (keyword), Lang_eiffel);
-
-    return id;
+    return (keywordId) lexLookupKeyword (name, Lang_eiffel);
 }
 
 static void readToken (tokenInfo *const token)
@@ -621,9 +632,7 @@ static void readToken (tokenInfo *const token)
 
 getNextChar:
 
-    do
-	c = fileGetc ();
-    while (c == '\t'  ||  c == ' '  ||  c == '\n');
+    c = fileGetSpan (NULL, EiffelClasses, LEX_SPACE);
 
     switch (c)
     {
@@ -716,7 +725,7 @@ getNextChar:
 	    break;
 
 	default:
-	    if (isalpha (c))
+	    if (lexIsClass (EiffelClasses, c, LEX_IDENT_START))
 	    {
 		parseIdentifier (token->string, c);
 		token->keyword = analyzeToken (token->string);
@@ -1198,8 +1207,15 @@ static void deleteToken (tokenInfo *const token)
 
 static void initialize (const langType language)
 {
+    int c;
+
     Lang_eiffel = language;
     buildEiffelKeywordHash ();
+    lexSetClass (EiffelClasses, " \t\n", LEX_SPACE);
+    lexSetClass (EiffelClasses, LEX_LETTERS, LEX_IDENT_START | LEX_IDENT);
+    lexSetClass (EiffelClasses, LEX_DIGITS "_", LEX_IDENT);
+    for (c = ' ' + 1  ;  c <= UCHAR_MAX  ;  ++c)
+	EiffelClasses [c] |= EIFFEL_OPERATOR;
 }
 
 static void findEiffelTags (void)
@@ -39,22 +39,35 @@
 #endif
 
 #include "debug.h"
+#include "binfmt.h"
+#include "bintags.h"
 #include "ctags.h"
+#include "dedup.h"
 #include "entry.h"
+#include "lzfmt.h"
+#include "lztags.h"
 #include "main.h"
 #include "options.h"
+#include "profile.h"
 #include "read.h"
 #include "routines.h"
 #include "sort.h"
 #include "strlist.h"
+#include "trace.h"
 
 /*
 *   MACROS
 */
-#define PSEUDO_TAG_PREFIX	"!_"
+
+/*  Size beyond which an etags section is spilled to a temporary file rather
+ *  than being held in memory until the source file is finished.
+ */
+#define ETAGS_SPILL_SIZE	65536
 
 #define includeExtensionFlags()		(Option.tagFileFormat > 1)
 
+#define JSON_TAG_PREFIX		"{\"_type\": \"tag\""
+
 /*
  *  Portability defines
  */
@@ -81,8 +94,9 @@ tagFile TagFile = {
     NULL,		/* file pointer */
     { 0, 0 },		/* numTags */
     { 0, 0, 0 },	/* max */
-    { NULL, NULL, 0 },	/* etags */
-    NULL		/* vLine */
+    { NULL, NULL, 0, NULL },	/* etags */
+    NULL,		/* vLine */
+    NULL		/* output */
 };
 
 static boolean TagsToStdout = FALSE;
@@ -106,6 +120,9 @@ extern void freeTagFileResources (void)
 {
     eFree (TagFile.directory);
     vStringDelete (TagFile.vLine);
+    vStringDelete (TagFile.etags.section);
+    vStringDelete (TagFile.output);
+    freeBinaryTagResources ();
 }
 
 extern const char *tagFileName (void)
@@ -113,10 +130,47 @@ extern const char *tagFileName (void)
     return TagFile.name;
 }
 
+/*  In filter and watch modes, and for binary output, tags are held in memory
+ *  rather than being written to the tag file as they are made. JSON output is
+ *  held only until the source file is finished.
+ */
+extern boolean isTagOutputBuffered (void)
+{
+    return (boolean) (Option.filter  ||  Option.watch  ||
+		      Option.outputFormat != OF_CTAGS);
+}
+
+/*  Is the tag file written only when it is closed (or replaced)?
+ */
+static boolean isTagFileDeferred (void)
+{
+    return (boolean) (Option.watch  ||  Option.outputFormat == OF_BINARY);
+}
+
 /*
 *   Pseudo tag support
 */
 
+/*  Writes the contents of a buffer to a file and clears it.
+ */
+static void writeBuffer (vString *const buffer, FILE *const fp)
+{
+    const size_t length = vStringLength (buffer);
+
+    if (length > 0  &&
+	fwrite (vStringValue (buffer), (size_t) 1, length, fp) < length)
+	error (FATAL | PERROR, "cannot complete write");
+    vStringClear (buffer);
+}
+
+static void putNumber (vString *const string, const char *const format,
+		       const unsigned long number)
+{
+    char buffer [24];
+    sprintf (buffer, format, number);
+    vStringCatS (string, buffer);
+}
+
 static void rememberMaxLengths (const size_t nameLength, const size_t lineLength)
 {
     if (nameLength > TagFile.max.tag)
@@ -130,10 +184,18 @@ static void writePseudoTag (const char *const tagName,
 			    const char *const fileName,
 			    const char *const pattern)
 {
-    const int length = fprintf (TagFile.fp, "%s%s\t%s\t/%s/\n",
-			       PSEUDO_TAG_PREFIX, tagName, fileName, pattern);
+    vString *const output = TagFile.output;
+
+    vStringCatS (output, PSEUDO_TAG_PREFIX);
+    vStringCatS (output, tagName);
+    vStringPut (output, '\t');
+    vStringCatS (output, fileName);
+    vStringCatS (output, "\t/");
+    vStringCatS (output, pattern);
+    vStringCatS (output, "/\n");
     ++TagFile.numTags.added;
-    rememberMaxLengths (strlen (tagName), (size_t) length);
+    rememberMaxLengths (strlen (tagName), vStringLength (output));
+    writeBuffer (output, TagFile.fp);
 }
 
 static void addPseudoTags (void)
@@ -312,11 +374,14 @@ static boolean isEtagsLine (const char *const line)
     return result;
 }
 
-static boolean isTagFile (const char *const filename)
+extern boolean isTagFile (const char *const filename)
 {
     boolean ok = FALSE;			/* we assume not unless confirmed */
     FILE *const fp = fopen (filename, "rb");
 
+    if (TagFile.vLine == NULL)
+	TagFile.vLine = vStringNew ();
+
     if (fp == NULL  &&  errno == ENOENT)
 	ok = TRUE;
     else if (fp != NULL)
@@ -326,7 +391,18 @@ static boolean isTagFile (const char *const filename)
 	if (line == NULL)
 	    ok = TRUE;
 	else
-	    ok = (boolean) (isCtagsLine (line) || isEtagsLine (line));
+	{
+	    /*  A binary, compressed or JSON tag file may be overwritten, but
+	     *  text appended to it would be lost or would leave it unreadable.
+	     */
+	    const boolean overwrite = (boolean) (! Option.append  &&  ! Option.etags);
+
+	    ok = (boolean) (isCtagsLine (line) || isEtagsLine (line) ||
+		    (overwrite  &&  strncmp (line, BIN_MAGIC, BIN_MAGIC_LENGTH) == 0) ||
+		    (overwrite  &&  strncmp (line, LZ_MAGIC, LZ_MAGIC_LENGTH) == 0) ||
+		    (! Option.append  &&  strncmp (line, JSON_TAG_PREFIX,
+					      strlen (JSON_TAG_PREFIX)) == 0));
+	}
 	fclose (fp);
     }
     return ok;
@@ -377,10 +453,17 @@ extern void openTagFile (void)
 
     if (TagFile.vLine == NULL)
 	TagFile.vLine = vStringNew ();
+    if (TagFile.output == NULL)
+	TagFile.output = vStringNew ();
 
-    /*  Open the tags file.
+    /*  Open the tags file. In filter mode, the tags for each file are held
+     *  in memory and written to stdout by closeTagFile ().
      */
-    if (TagsToStdout)
+    if (Option.filter)
+	TagFile.fp = NULL;
+    else if (TagsToStdout  &&  Option.outputFormat == OF_JSON)
+	TagFile.fp = stdout;	/* never sorted, so streamed directly */
+    else if (TagsToStdout)
 	TagFile.fp = tempFile ("w", &TagFile.name);
     else
     {
@@ -394,7 +477,9 @@ extern void openTagFile (void)
 	      "\"%s\" doesn't look like a tag file; I refuse to overwrite it.",
 		  TagFile.name);
 
-	if (Option.etags)
+	if (isTagFileDeferred ())
+	    ;		/* written by replaceTagFile () or closeTagFile () */
+	else if (Option.etags)
 	{
 	    if (Option.append  &&  fileExists)
 		TagFile.fp = fopen (TagFile.name, "a+b");
@@ -416,16 +501,18 @@ extern void openTagFile (void)
 	    else
 	    {
 		TagFile.fp = fopen (TagFile.name, "w");
-		if (TagFile.fp != NULL)
+		if (TagFile.fp != NULL  &&  Option.outputFormat == OF_CTAGS)
 		    addPseudoTags ();
 	    }
 	}
-	if (TagFile.fp == NULL)
+	if (TagFile.fp == NULL  &&  ! isTagFileDeferred ())
 	{
 	    error (FATAL | PERROR, "cannot open tag file");
 	    exit (1);
 	}
     }
+    if (TagFile.directory != NULL)
+	eFree (TagFile.directory);	/* opened once per file in filter mode */
     if (TagsToStdout)
 	TagFile.directory = eStrdup (CurrentDirectory);
     else
@@ -453,6 +540,7 @@ static int replacementTruncate (const char *const name, const long size)
 
 static void sortTagFile (void)
 {
+    traceBegin ("ctags", "sortTagFile", NULL);
     if (TagFile.numTags.added > 0L)
     {
 	if (Option.sorted != SO_UNSORTED)
@@ -469,6 +557,7 @@ static void sortTagFile (void)
     }
     if (TagsToStdout)
 	remove (tagFileName ());		/* remove temporary file */
+    traceEnd ("ctags", "sortTagFile");
 }
 
 static void resizeTagFile (const long newSize)
@@ -502,7 +591,7 @@ static void resizeTagFile (const long newSize)
 	fprintf (errout, "Cannot shorten tag file: errno = %d\n", errno);
 }
 
-static void writeEtagsIncludes (FILE *const fp)
+static void writeEtagsIncludes (vString *const output)
 {
     if (Option.etagsInclude)
     {
@@ -510,17 +599,29 @@ static void writeEtagsIncludes (FILE *const fp)
 	for (i = 0  ;  i < stringListCount (Option.etagsInclude)  ;  ++i)
 	{
 	    vString *item = stringListItem (Option.etagsInclude, i);
-	    fprintf (fp, "\f\n%s,include\n", vStringValue (item));
+	    vStringCatS (output, "\f\n");
+	    vStringCat (output, item);
+	    vStringCatS (output, ",include\n");
 	}
     }
 }
 
-extern void closeTagFile (const boolean resize)
+/*  Writes the tags held in memory for a file in filter mode to stdout,
+ *  sorting them first if required.
+ */
+static void writeFilterOutput (void)
+{
+    if (Option.sorted != SO_UNSORTED)
+	sortTagBuffer (TagFile.output);
+    writeBuffer (TagFile.output, stdout);
+    fflush (stdout);
+}
+
+static void closeTagFileStream (const boolean resize)
 {
     long desiredSize, size;
 
-    if (Option.etags)
-	writeEtagsIncludes (TagFile.fp);
+    writeBuffer (TagFile.output, TagFile.fp);
     desiredSize = ftell (TagFile.fp);
     fseek (TagFile.fp, 0L, SEEK_END);
     size = ftell (TagFile.fp);
@@ -533,31 +634,123 @@ extern void closeTagFile (const boolean resize)
 	resizeTagFile (desiredSize);
     }
     sortTagFile ();
+    if (Option.compress)
+	compressTagFile (TagFile.name);
     eFree (TagFile.name);
     TagFile.name = NULL;
 }
 
+/*  Writes the JSON objects held for a source file, so that they may be read
+ *  while later files are being parsed.
+ */
+extern void flushTagOutput (void)
+{
+    writeBuffer (TagFile.output, TagFile.fp);
+    fflush (TagFile.fp);
+}
+
+static void closeJsonStream (void)
+{
+    writeBuffer (TagFile.output, TagFile.fp);
+    if (TagFile.fp == stdout)
+	fflush (stdout);
+    else if (fclose (TagFile.fp) != 0)
+	error (FATAL | PERROR, "cannot write tag file \"%s\"", TagFile.name);
+    TagFile.fp = NULL;
+    if (TagFile.name != NULL)
+	eFree (TagFile.name);
+    TagFile.name = NULL;
+}
+
+extern void closeTagFile (const boolean resize)
+{
+    if (Option.etags)
+	writeEtagsIncludes (TagFile.output);
+    if (Option.filter)
+	writeFilterOutput ();
+    else if (Option.outputFormat == OF_BINARY)
+    {
+	writeBinaryTagFile (TagFile.name);
+	eFree (TagFile.name);
+	TagFile.name = NULL;
+    }
+    else if (Option.outputFormat == OF_JSON)
+	closeJsonStream ();
+    else
+	closeTagFileStream (resize);
+}
+
+/*  Writes a complete tag file from tags held in memory, replacing the tag
+ *  file atomically: the tags are written to a new file in the same
+ *  directory, which is then renamed over the old one.
+ */
+extern void replaceTagFile (vString *const tags)
+{
+    vString *const newName = vStringNewInit (TagFile.name);
+
+    vStringCatS (newName, NEW_TAG_FILE_SUFFIX);
+    TagFile.fp = fopen (vStringValue (newName), "w");
+    if (TagFile.fp == NULL)
+	error (FATAL | PERROR, "cannot open tag file \"%s\"",
+	       vStringValue (newName));
+    addPseudoTags ();
+    writeBuffer (tags, TagFile.fp);
+    if (fclose (TagFile.fp) != 0)
+	error (FATAL | PERROR, "cannot write tag file \"%s\"",
+	       vStringValue (newName));
+    TagFile.fp = NULL;
+    if (rename (vStringValue (newName), TagFile.name) != 0)
+	error (FATAL | PERROR, "cannot replace tag file \"%s\"", TagFile.name);
+    vStringDelete (newName);
+}
+
+/*  The entries for each source file are preceded in an etags file by the
+ *  size of those entries, so they are collected in memory until the source
+ *  file is finished. Only sections too large to be reasonably held in memory
+ *  are staged through a temporary file.
+ */
 extern void beginEtagsFile (void)
 {
-    TagFile.etags.fp = tempFile ("w+b", &TagFile.etags.name);
+    if (TagFile.etags.section == NULL)
+	TagFile.etags.section = vStringNew ();
+    vStringClear (TagFile.etags.section);
+    TagFile.etags.fp = NULL;
     TagFile.etags.byteCount = 0;
 }
 
+static void spillEtagsSection (void)
+{
+    if (TagFile.etags.fp == NULL)
+	TagFile.etags.fp = tempFile ("w+b", &TagFile.etags.name);
+    writeBuffer (TagFile.etags.section, TagFile.etags.fp);
+}
+
 extern void endEtagsFile (const char *const name)
 {
-    const char *line;
+    vString *const output = TagFile.output;
 
-    fprintf (TagFile.fp, "\f\n%s,%ld\n", name, (long) TagFile.etags.byteCount);
-    if (TagFile.etags.fp != NULL)
+    vStringCatS (output, "\f\n");
+    vStringCatS (output, name);
+    putNumber (output, ",%lu\n", (unsigned long) TagFile.etags.byteCount);
+    if (Option.filter)
     {
-	rewind (TagFile.etags.fp);
-	while ((line = readLine (TagFile.vLine, TagFile.etags.fp)) != NULL)
-	    fputs (line, TagFile.fp);
-	fclose (TagFile.etags.fp);
-	remove (TagFile.etags.name);
-	eFree (TagFile.etags.name);
-	TagFile.etags.fp = NULL;
-	TagFile.etags.name = NULL;
+	vStringCat (output, TagFile.etags.section);
+	vStringClear (TagFile.etags.section);
+    }
+    else
+    {
+	writeBuffer (output, TagFile.fp);
+	if (TagFile.etags.fp != NULL)
+	{
+	    rewind (TagFile.etags.fp);
+	    copyBytes (TagFile.etags.fp, TagFile.fp, WHOLE_FILE);
+	    fclose (TagFile.etags.fp);
+	    remove (TagFile.etags.name);
+	    eFree (TagFile.etags.name);
+	    TagFile.etags.fp = NULL;
+	    TagFile.etags.name = NULL;
+	}
+	writeBuffer (TagFile.etags.section, TagFile.fp);
     }
 }
 
@@ -565,14 +758,13 @@ extern void endEtagsFile (const char *const name)
  *  Tag entry management
  */
 
-/*  This function copies the current line out to a specified file. It has no
+/*  This function copies the current line out to a buffer. It has no
  *  effect on the fileGetc () function.  During copying, any '\' characters
  *  are doubled and a leading '^' or trailing '$' is also quoted. End of line
  *  characters (line feed or carriage return) are dropped.
  */
-static size_t writeSourceLine (FILE *const fp, const char *const line)
+static void writeSourceLine (vString *const output, const char *const line)
 {
-    size_t length = 0;
     const char *p;
 
     /*	Write everything up to, but not including, a line end character.
@@ -589,22 +781,17 @@ static size_t writeSourceLine (FILE *const fp, const char *const line)
 	 */
 	if (c == BACKSLASH  ||  c == (Option.backward ? '?' : '/')  ||
 	    (c == '$'  &&  (next == NEWLINE  ||  next == CRETURN)))
-	{
-	    putc (BACKSLASH, fp);
-	    ++length;
-	}
-	putc (c, fp);
-	++length;
+	    vStringPut (output, BACKSLASH);
+	vStringPut (output, c);
     }
-    return length;
 }
 
 /*  Writes "line", stripping leading and duplicate white space.
  */
-static size_t writeCompactSourceLine (FILE *const fp, const char *const line)
+static void writeCompactSourceLine (vString *const output,
+				    const char *const line)
 {
     boolean lineStarted = FALSE;
-    size_t  length = 0;
     const char *p;
     int c;
 
@@ -626,33 +813,45 @@ static size_t writeCompactSourceLine (FILE *const fp, const char *const line)
 		c = ' ';	/* force space character for any white space */
 	    }
 	    if (c != CRETURN  ||  *(p + 1) != NEWLINE)
-	    {
-		putc (c, fp);
-		++length;
-	    }
+		vStringPut (output, c);
 	}
     }
-    return length;
+}
+
+/*  Appends a string, padded with spaces to a minimum width, and a space.
+ */
+static void putPadded (vString *const output, const char *const string,
+		       const size_t width)
+{
+    size_t length = 0;
+
+    if (string != NULL)
+    {
+	vStringCatS (output, string);
+	length = strlen (string);
+    }
+    for ( ;  length < width  ;  ++length)
+	vStringPut (output, ' ');
+    vStringPut (output, ' ');
 }
 
 static int writeXrefEntry (const tagEntryInfo *const tag)
 {
     const char *const line =
 	    readSourceLine (TagFile.vLine, tag->filePosition, NULL);
-    int length;
+    vString *const output = TagFile.output;
+    const size_t start = vStringLength (output);
 
-    if (Option.tagFileFormat == 1)
-	length = fprintf (TagFile.fp, "%-16s %4lu %-16s ", tag->name,
-		tag->lineNumber, tag->sourceFileName);
-    else
-	length = fprintf (TagFile.fp, "%-16s %-10s %4lu %-16s ", tag->name,
-		tag->kindName, tag->lineNumber, tag->sourceFileName);
+    putPadded (output, tag->name, 16);
+    if (Option.tagFileFormat != 1)
+	putPadded (output, tag->kindName, 10);
+    putNumber (output, "%4lu ", tag->lineNumber);
+    putPadded (output, tag->sourceFileName, 16);
 
-    length += writeCompactSourceLine (TagFile.fp, line);
-    putc (NEWLINE, TagFile.fp);
-    ++length;
+    writeCompactSourceLine (output, line);
+    vStringPut (output, NEWLINE);
 
-    return length;
+    return (int) (vStringLength (output) - start);
 }
 
 /*  Truncates the text line containing the tag at the character following the
@@ -674,11 +873,13 @@ static void truncateTagLine (char *const line, const char *const token,
 
 static int writeEtagsEntry (const tagEntryInfo *const tag)
 {
+    vString *const section = TagFile.etags.section;
+    const size_t start = vStringLength (section);
+    char position [42];
     int length;
 
     if (tag->isFileEntry)
-	length = fprintf (TagFile.etags.fp, "\177%s\001%lu,0\n",
-			 tag->name, tag->lineNumber);
+	sprintf (position, "%lu,0\n", tag->lineNumber);
     else
     {
 	long seekValue;
@@ -690,110 +891,266 @@ static int writeEtagsEntry (const tagEntryInfo *const tag)
 	else
 	    line [strlen (line) - 1] = '\0';
 
-	length = fprintf (TagFile.etags.fp, "%s\177%s\001%lu,%ld\n", line,
-			 tag->name, tag->lineNumber, seekValue);
+	vStringCatS (section, line);
+	sprintf (position, "%lu,%ld\n", tag->lineNumber, seekValue);
     }
+    vStringPut (section, '\177');
+    vStringCatS (section, tag->name);
+    vStringPut (section, '\001');
+    vStringCatS (section, position);
+
+    length = (int) (vStringLength (section) - start);
     TagFile.etags.byteCount += length;
+    if (vStringLength (section) > (size_t) ETAGS_SPILL_SIZE  &&  ! Option.filter)
+	spillEtagsSection ();
 
     return length;
 }
 
-static int addExtensionFields (const tagEntryInfo *const tag)
+static void addExtensionField (extensionFieldList *const fields,
+			       const char *const key, const char *const value)
+{
+    Assert (fields->count < MAX_EXTENSION_FIELDS);
+    fields->item [fields->count].key = key;
+    fields->item [fields->count].value = value;
+    ++fields->count;
+}
+
+/*  Lists the extension fields of a tag selected by the --fields option.
+ */
+extern void getExtensionFields (const tagEntryInfo *const tag,
+				extensionFieldList *const fields)
 {
-    const char* const kindKey = Option.extensionFields.kindKey ? "kind:" : "";
-    boolean first = TRUE;
-    const char* separator = ";\"";
-    const char* const empty = "";
-    int length = 0;
-/* "sep" returns a value only the first time it is evaluated */
-#define sep (first ? (first = FALSE, separator) : empty)
+    const char* const kindKey = Option.extensionFields.kindKey ? "kind" : NULL;
 
+    fields->count = 0;
     if (tag->kindName != NULL && (Option.extensionFields.kindLong  ||
 	 (Option.extensionFields.kind  && tag->kind == '\0')))
-	length += fprintf (TagFile.fp,"%s\t%s%s", sep, kindKey, tag->kindName);
+	addExtensionField (fields, kindKey, tag->kindName);
     else if (tag->kind != '\0'  && (Option.extensionFields.kind  ||
 	    (Option.extensionFields.kindLong  &&  tag->kindName == NULL)))
-	length += fprintf (TagFile.fp, "%s\t%s%c", sep, kindKey, tag->kind);
+    {
+	fields->kind [0] = tag->kind;
+	fields->kind [1] = '\0';
+	addExtensionField (fields, kindKey, fields->kind);
+    }
 
     if (Option.extensionFields.lineNumber)
-	length += fprintf (TagFile.fp, "%s\tline:%ld", sep, tag->lineNumber);
+    {
+	sprintf (fields->lineNumber, "%lu", tag->lineNumber);
+	addExtensionField (fields, "line", fields->lineNumber);
+    }
 
     if (Option.extensionFields.language  &&  tag->language != NULL)
-	length += fprintf (TagFile.fp, "%s\tlanguage:%s", sep, tag->language);
+	addExtensionField (fields, "language", tag->language);
 
     if (Option.extensionFields.scope  &&
 	    tag->extensionFields.scope [0] != NULL  &&
 	    tag->extensionFields.scope [1] != NULL)
-	length += fprintf (TagFile.fp, "%s\t%s:%s", sep,
-			   tag->extensionFields.scope [0],
+	addExtensionField (fields, tag->extensionFields.scope [0],
 			   tag->extensionFields.scope [1]);
 
     if (Option.extensionFields.fileScope  &&  tag->isFileScope)
-	length += fprintf (TagFile.fp, "%s\tfile:", sep);
+	addExtensionField (fields, "file", "");
 
     if (Option.extensionFields.inheritance  &&
 	    tag->extensionFields.inheritance != NULL)
-	length += fprintf (TagFile.fp, "%s\tinherits:%s", sep,
+	addExtensionField (fields, "inherits",
 			   tag->extensionFields.inheritance);
 
     if (Option.extensionFields.access  &&  tag->extensionFields.access != NULL)
-	length += fprintf (TagFile.fp, "%s\taccess:%s", sep,
-			   tag->extensionFields.access);
+	addExtensionField (fields, "access", tag->extensionFields.access);
 
     if (Option.extensionFields.implementation  &&
 	    tag->extensionFields.implementation != NULL)
-	length += fprintf (TagFile.fp, "%s\timplementation:%s", sep,
+	addExtensionField (fields, "implementation",
 			   tag->extensionFields.implementation);
 
     if (Option.extensionFields.signature  &&
 	    tag->extensionFields.signature != NULL)
-	length += fprintf (TagFile.fp, "%s\tsignature:%s", sep,
+	addExtensionField (fields, "signature",
 			   tag->extensionFields.signature);
+}
 
-    return length;
-#undef sep
+static void addExtensionFields (vString *const output,
+				const tagEntryInfo *const tag)
+{
+    extensionFieldList fields;
+    unsigned int i;
+
+    getExtensionFields (tag, &fields);
+    if (fields.count > 0)
+	vStringCatS (output, ";\"");
+    for (i = 0  ;  i < fields.count  ;  ++i)
+    {
+	vStringPut (output, '\t');
+	if (fields.item [i].key != NULL)
+	{
+	    vStringCatS (output, fields.item [i].key);
+	    vStringPut (output, ':');
+	}
+	vStringCatS (output, fields.item [i].value);
+    }
 }
 
-static int writePatternEntry (const tagEntryInfo *const tag)
+static void writePatternEntry (vString *const output,
+			       const tagEntryInfo *const tag)
 {
     char *const line = readSourceLine (TagFile.vLine, tag->filePosition, NULL);
     const int searchChar = Option.backward ? '?' : '/';
     boolean newlineTerminated;
-    int length = 0;
 
     if (tag->truncateLine)
 	truncateTagLine (line, tag->name, FALSE);
     newlineTerminated = (boolean) (line [strlen (line) - 1] == '\n');
 
-    length += fprintf (TagFile.fp, "%c^", searchChar);
-    length += writeSourceLine (TagFile.fp, line);
-    length += fprintf (TagFile.fp, "%s%c", newlineTerminated ? "$":"",
-		      searchChar);
+    vStringPut (output, searchChar);
+    vStringPut (output, '^');
+    writeSourceLine (output, line);
+    if (newlineTerminated)
+	vStringPut (output, '$');
+    vStringPut (output, searchChar);
+}
+
+static void writeLineNumberEntry (vString *const output,
+				  const tagEntryInfo *const tag)
+{
+    putNumber (output, "%lu", tag->lineNumber);
+}
+
+/*  Only the address of a binary tag is formatted; the tag is held until the
+ *  tag file is closed.
+ */
+static int writeBinaryEntry (const tagEntryInfo *const tag)
+{
+    vString *const address = TagFile.output;
+    int length;
+
+    if (tag->lineNumberEntry)
+	writeLineNumberEntry (address, tag);
+    else
+	writePatternEntry (address, tag);
+    vStringTerminate (address);
+    captureBinaryTag (tag, vStringValue (address));
+    length = (int) vStringLength (address);
+    vStringClear (address);
 
     return length;
 }
 
-static int writeLineNumberEntry (const tagEntryInfo *const tag)
+/*  Appends a string as a JSON string, escaping quotes, backslashes and
+ *  control characters. Other bytes are copied unchanged.
+ */
+static void putJsonString (vString *const output, const char *const string)
+{
+    const unsigned char *p;
+
+    vStringPut (output, '"');
+    for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+    {
+	const int c = *p;
+
+	if (c == '"'  ||  c == BACKSLASH)
+	{
+	    vStringPut (output, BACKSLASH);
+	    vStringPut (output, c);
+	}
+	else if (c == NEWLINE)
+	    vStringCatS (output, "\\n");
+	else if (c == CRETURN)
+	    vStringCatS (output, "\\r");
+	else if (c == '\t')
+	    vStringCatS (output, "\\t");
+	else if (c < 0x20)
+	    putNumber (output, "\\u%04lx", (unsigned long) c);
+	else
+	    vStringPut (output, c);
+    }
+    vStringPut (output, '"');
+}
+
+static void addJsonField (vString *const output, const char *const key,
+			  const char *const value)
 {
-    return fprintf (TagFile.fp, "%lu", tag->lineNumber);
+    if (value != NULL)
+    {
+	vStringCatS (output, ", \"");
+	vStringCatS (output, key);
+	vStringCatS (output, "\": ");
+	putJsonString (output, value);
+    }
+}
+
+/*  Writes a tag as a single line holding a JSON object. All of the fields
+ *  known for the tag are written, whatever the setting of --fields.
+ */
+static int writeJsonEntry (const tagEntryInfo *const tag)
+{
+    vString *const output = TagFile.output;
+    const size_t start = vStringLength (output);
+
+    vStringCatS (output, JSON_TAG_PREFIX);
+    vStringCatS (output, ", \"name\": ");
+    putJsonString (output, tag->name);
+    addJsonField (output, "path", tag->sourceFileName);
+    if (! tag->lineNumberEntry)
+    {
+	vString *const pattern = vStringNew ();
+	writePatternEntry (pattern, tag);
+	vStringTerminate (pattern);
+	addJsonField (output, "pattern", vStringValue (pattern));
+	vStringDelete (pattern);
+    }
+    putNumber (output, ", \"line\": %lu", tag->lineNumber);
+    addJsonField (output, "language", tag->language);
+    if (tag->kindName != NULL)
+	addJsonField (output, "kind", tag->kindName);
+    else if (tag->kind != '\0')
+    {
+	char kind [2];
+	kind [0] = tag->kind;
+	kind [1] = '\0';
+	addJsonField (output, "kind", kind);
+    }
+    if (tag->extensionFields.scope [0] != NULL  &&
+	tag->extensionFields.scope [1] != NULL)
+    {
+	addJsonField (output, "scope", tag->extensionFields.scope [1]);
+	addJsonField (output, "scopeKind", tag->extensionFields.scope [0]);
+    }
+    if (tag->isFileScope)
+	vStringCatS (output, ", \"file\": true");
+    addJsonField (output, "access", tag->extensionFields.access);
+    addJsonField (output, "implementation",
+		  tag->extensionFields.implementation);
+    addJsonField (output, "inherits", tag->extensionFields.inheritance);
+    addJsonField (output, "signature", tag->extensionFields.signature);
+    vStringCatS (output, "}\n");
+
+    return (int) (vStringLength (output) - start);
 }
 
 static int writeCtagsEntry (const tagEntryInfo *const tag)
 {
-    int length = fprintf (TagFile.fp, "%s\t%s\t",
-			  tag->name, tag->sourceFileName);
+    vString *const output = TagFile.output;
+    const size_t start = vStringLength (output);
+
+    vStringCatS (output, tag->name);
+    vStringPut (output, '\t');
+    vStringCatS (output, tag->sourceFileName);
+    vStringPut (output, '\t');
 
     if (tag->lineNumberEntry)
-	length += writeLineNumberEntry (tag);
+	writeLineNumberEntry (output, tag);
     else
-	length += writePatternEntry (tag);
+	writePatternEntry (output, tag);
 
     if (includeExtensionFlags ())
-	length += addExtensionFields (tag);
+	addExtensionFields (output, tag);
 
-    length += fprintf (TagFile.fp, "\n");
+    vStringPut (output, NEWLINE);
 
-    return length;
+    return (int) (vStringLength (output) - start);
 }
 
 extern void makeTagEntry (const tagEntryInfo *const tag)
@@ -806,6 +1163,8 @@ extern void makeTagEntry (const tagEntryInfo *const tag)
 	int length = 0;
 
 	DebugStatement ( debugEntry (tag); )
+	traceBegin ("ctags", "makeTagEntry", NULL);
+	profileBeginPhase (PHASE_WRITE);
 	if (Option.xref)
 	{
 	    if (! tag->isFileEntry)
@@ -813,12 +1172,23 @@ extern void makeTagEntry (const tagEntryInfo *const tag)
 	}
 	else if (Option.etags)
 	    length = writeEtagsEntry (tag);
+	else if (Option.outputFormat == OF_BINARY)
+	    length = writeBinaryEntry (tag);
+	else if (Option.outputFormat == OF_JSON)
+	    length = writeJsonEntry (tag);
 	else
 	    length = writeCtagsEntry (tag);
+	if (! isTagOutputBuffered ())
+	    writeBuffer (TagFile.output, TagFile.fp);
+	profileEndPhase ();
 
 	++TagFile.numTags.added;
 	rememberMaxLengths (strlen (tag->name), (size_t) length);
-	DebugStatement ( fflush (TagFile.fp); )
+	DebugStatement ( if (TagFile.fp != NULL) fflush (TagFile.fp); )
+
+	if (Option.dedup)
+	    dedupCaptureTag (tag);
+	traceEnd ("ctags", "makeTagEntry");
     }
 }
 
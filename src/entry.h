@@ -24,6 +24,9 @@
 *   MACROS
 */
 #define WHOLE_FILE  -1L
+#define PSEUDO_TAG_PREFIX	"!_"
+#define NEW_TAG_FILE_SUFFIX	".new"	/* tag file being replaced */
+#define MAX_EXTENSION_FIELDS	10
 
 /*
 *   DATA DECLARATIONS
@@ -39,10 +42,12 @@ typedef struct eTagFile {
     struct sMax { size_t line, tag, file; } max;
     struct sEtags {
 	char *name;
-	FILE *fp;
+	FILE *fp;		/* spill file for very large sections */
 	size_t byteCount;
+	vString *section;	/* entries for current source file */
     } etags;
     vString *vLine;
+    vString *output;		/* tags formatted but not yet written */
 } tagFile;
 
 typedef struct sTagFields {
@@ -75,6 +80,19 @@ typedef struct sTagEntryInfo {
     } extensionFields;		/* list of extension fields*/
 } tagEntryInfo;
 
+/*  The extension fields selected for output for a tag, in the order written.
+ *  A field without a key is the kind of the tag, written bare.
+ */
+typedef struct sExtensionFieldList {
+    unsigned int count;
+    struct sExtensionField {
+	const char *key;
+	const char *value;
+    } item [MAX_EXTENSION_FIELDS];
+    char kind [2];		/* storage for single character kind */
+    char lineNumber [24];	/* storage for line number */
+} extensionFieldList;
+
 /*
 *   GLOBAL VARIABLES
 */
@@ -85,12 +103,17 @@ extern tagFile TagFile;
 */
 extern void freeTagFileResources (void);
 extern const char *tagFileName (void);
+extern boolean isTagOutputBuffered (void);
+extern boolean isTagFile (const char *const filename);
 extern void copyBytes (FILE* const fromFp, FILE* const toFp, const long size);
 extern void copyFile (const char *const from, const char *const to, const long size);
 extern void openTagFile (void);
+extern void flushTagOutput (void);
 extern void closeTagFile (const boolean resize);
+extern void replaceTagFile (vString *const tags);
 extern void beginEtagsFile (void);
 extern void endEtagsFile (const char *const name);
+extern void getExtensionFields (const tagEntryInfo *const tag, extensionFieldList *const fields);
 extern void makeTagEntry (const tagEntryInfo *const tag);
 extern void initTagEntry (tagEntryInfo *const e, const char *const name);
 
@@ -23,6 +23,7 @@
 #include "debug.h"
 #include "entry.h"
 #include "keyword.h"
+#include "lexer.h"
 #include "options.h"
 #include "parse.h"
 #include "read.h"
@@ -32,12 +33,13 @@
 /*
 *   MACROS
 */
-#define isident(c)		(isalnum(c) || (c) == '_')
+#define isident(c)		lexIsClass (FortranClasses, c, LEX_IDENT)
 #define isBlank(c)		(boolean) (c == ' ' || c == '\t')
 #define isType(token,t)		(boolean) ((token)->type == (t))
 #define isKeyword(token,k)	(boolean) ((token)->keyword == (k))
 #define isSecondaryKeyword(token,k)  (boolean) ((token)->secondary == NULL ? \
     FALSE : (token)->secondary->keyword == (k))
+#define PREFIX_SIZE		16384	/* bytes examined to detect source form */
 
 /*
 *   DATA DECLARATIONS
@@ -197,7 +199,10 @@ static jmp_buf Exception;
 static int Ungetc = '\0';
 static unsigned int Column = 0;
 static boolean FreeSourceForm = FALSE;
+static char Prefix [PREFIX_SIZE];	/* start of file, to detect source form */
 static tokenInfo *Parent = NULL;
+static lexClassTable FortranClasses;
+static lexPool *Tokens = NULL;		/* released tokens, for reuse */
 
 /* indexed by tagType */
 static kindOption FortranKinds [] = {
@@ -414,12 +419,18 @@ static void buildFortranKeywordHash (void)
 
 static tokenInfo *newToken (void)
 {
-    tokenInfo *const token = xMalloc (1, tokenInfo);
+    tokenInfo *token = lexPoolGet (Tokens);
 
+    if (token == NULL)
+    {
+	token = xMalloc (1, tokenInfo);
+	token->string = vStringNew ();
+    }
+    else
+	vStringClear (token->string);
     token->type	        = TOKEN_UNDEFINED;
     token->keyword      = KEYWORD_NONE;
     token->tag	        = TAG_UNDEFINED;
-    token->string       = vStringNew ();
     token->secondary    = NULL;
     token->lineNumber   = getSourceLineNumber ();
     token->filePosition	= getInputFilePosition ();
@@ -430,20 +441,28 @@ static tokenInfo *newToken (void)
 static tokenInfo *newTokenFrom (tokenInfo *const token)
 {
     tokenInfo *result = newToken ();
+    vString *const string = result->string;
     *result = *token;
-    result->string = vStringNewCopy (token->string);
+    result->string = string;
+    vStringCopy (result->string, token->string);
     token->secondary = NULL;
     return result;
 }
 
+static void destroyToken (void *const object)
+{
+    tokenInfo *const token = (tokenInfo *) object;
+    vStringDelete (token->string);
+    eFree (token);
+}
+
 static void deleteToken (tokenInfo *const token)
 {
     if (token != NULL)
     {
-	vStringDelete (token->string);
 	deleteToken (token->secondary);
 	token->secondary = NULL;
-	eFree (token);
+	lexPoolPut (Tokens, token);
     }
 }
 
@@ -597,6 +616,86 @@ static lineType getLineType (void)
     return type;
 }
 
+/*  Would a fixed form parse reject the line (which does not include its
+ *  newline)? This applies the same tests as getLineType () to the margin
+ *  and, as getFixedFormChar () does, looks for a '&' ending the line. Only
+ *  a '&' which follows other text on the line is counted, since a '&'
+ *  beginning the statement field escapes that test, and none is counted
+ *  after a '!' outside of a character string, since readToken () skips the
+ *  comment that begins there.
+ */
+static boolean isFreeFormLine (const char *const line, const size_t length)
+{
+    boolean result = FALSE;
+    boolean label = FALSE;
+    boolean text = FALSE;
+    boolean comment = FALSE;
+    int delimiter = '\0';		/* of character string being scanned */
+    size_t column = 0;
+
+    if (length == 0  ||  strchr ("*Cc!#$Dd", line [0]) != NULL)
+	;				/* comment or short line */
+    else
+    {
+	while (column < length  &&  column < 6  &&  ! result)
+	{
+	    const int c = (unsigned char) line [column++];
+
+	    if (c == '\t')
+		break;
+	    else if (column == 6)
+		result = (boolean) (c != ' '  &&  c != '0'  &&  label);
+	    else if (isdigit (c))
+		label = TRUE;
+	    else if (c != ' ')
+		result = TRUE;
+	}
+	for (  ;  column + 1 < length  &&  ! result  &&  ! comment  ;  ++column)
+	{
+	    const int c = line [column];
+
+	    if (delimiter != '\0')
+	    {
+		if (c == delimiter)
+		    delimiter = '\0';
+	    }
+	    else if (c == '!')
+		comment = TRUE;
+	    else if (c == '"'  ||  c == '\'')
+		delimiter = c;
+	    if (! isBlank (c))
+		text = TRUE;
+	}
+	if (! result  &&  ! comment  &&  text  &&  column < length  &&
+	    line [column] == '&')
+	    result = TRUE;
+    }
+    return result;
+}
+
+/*  Examines the start of the file for any line which would make a fixed form
+ *  parse fail, so that a file in free source form need not be parsed twice.
+ *  A file showing no such line is parsed as fixed form, to be parsed again
+ *  as free form if one is found later.
+ */
+static boolean isFreeSourceFormPrefix (void)
+{
+    const size_t length = filePeek (Prefix, sizeof (Prefix));
+    boolean result = FALSE;
+    size_t start = 0;
+    size_t i;
+
+    for (i = 0  ;  i < length  &&  ! result  ;  ++i)
+    {
+	if (Prefix [i] == '\n'  ||  Prefix [i] == '\r')
+	{
+	    result = isFreeFormLine (Prefix + start, i - start);
+	    start = i + 1;
+	}
+    }
+    return result;
+}
+
 static int getFixedFormChar (void)
 {
     boolean newline = FALSE;
@@ -838,6 +937,20 @@ static void parseIdentifier (vString *const string, const int firstChar)
     do
     {
 	vStringPut (string, c);
+#ifndef STRICT_FIXED_FORM
+	/*  Within a line, the characters of an identifier need none of the
+	 *  processing of getChar (), so are read in bulk. Only the column
+	 *  need be kept for fixed source form.
+	 */
+	{
+	    const size_t length = vStringLength (string);
+
+	    Assert (Ungetc == '\0'  &&  (FreeSourceForm  ||  Column > 0));
+	    fileUngetc (fileGetSpan (string, FortranClasses, LEX_IDENT));
+	    if (! FreeSourceForm)
+		Column += vStringLength (string) - length;
+	}
+#endif
 	c = getChar ();
     } while (isident (c));
 
@@ -851,15 +964,7 @@ static void parseIdentifier (vString *const string, const int firstChar)
  */
 static keywordId analyzeToken (vString *const name)
 {
-    static vString *keyword = NULL;
-    keywordId id;
-
-    if (keyword == NULL)
-	keyword = vStringNew ();
-    vStringCopyToLower (keyword, name);
-    id = (keywordId) lookupKeyword (vStringValue (keyword), Lang_fortran);
-
-    return id;
+    return (keywordId) lexLookupKeyword (name, Lang_fortran);
 }
 
 static void checkForLabel (void)
@@ -986,7 +1091,7 @@ getNextChar:
 	    break;
 
 	default:
-	    if (isalpha (c))
+	    if (lexIsClass (FortranClasses, c, LEX_IDENT_START))
 	    {
 		parseIdentifier (token->string, c);
 		token->keyword = analyzeToken (token->string);
@@ -2117,9 +2222,17 @@ static boolean findFortranTags (const unsigned int passCount)
     boolean retry;
 
     Assert (passCount < 3);
+    Tokens = lexPoolNew (destroyToken);
     Parent = newToken ();
     token = newToken ();
-    FreeSourceForm = (boolean) (passCount > 1);
+    if (passCount > 1)
+	FreeSourceForm = TRUE;
+    else
+    {
+	FreeSourceForm = isFreeSourceFormPrefix ();
+	if (FreeSourceForm)
+	    verbose ("%s: parsing as free source form\n", getInputFileName ());
+    }
     Column = 0;
     exception = (exception_t) setjmp (Exception);
     if (exception == ExceptionEOF)
@@ -2138,6 +2251,8 @@ static boolean findFortranTags (const unsigned int passCount)
     ancestorClear ();
     deleteToken (token);
     deleteToken (Parent);
+    lexPoolDelete (Tokens);
+    Tokens = NULL;
 
     return retry;
 }
@@ -2146,6 +2261,8 @@ static void initialize (const langType language)
 {
     Lang_fortran = language;
     buildFortranKeywordHash ();
+    lexSetClass (FortranClasses, LEX_LETTERS, LEX_IDENT_START | LEX_IDENT);
+    lexSetClass (FortranClasses, LEX_DIGITS "_", LEX_IDENT);
 }
 
 extern parserDefinition* FortranParser (void)
@@ -37,7 +37,8 @@ typedef enum { COMMENT_NONE, COMMENT_C, COMMENT_CPLUS } Comment;
 
 enum eCppLimits {
     MaxCppNestingLevel = 20,
-    MaxDirectiveName = 10
+    MaxDirectiveName = 10,
+    MaxSkipStops = 4
 };
 
 /*  Defines the one nesting level of a preprocessor conditional.
@@ -438,7 +439,10 @@ static int skipOverCComment (void)
     while (c != EOF)
     {
 	if (c != '*')
+	{
+	    fileSkipToCharacter ("*");
 	    c = fileGetc ();
+	}
 	else
 	{
 	    const int next = fileGetc ();
@@ -461,12 +465,14 @@ static int skipOverCplusComment (void)
 {
     int c;
 
+    fileSkipToCharacter ("\\\n");
     while ((c = fileGetc ()) != EOF)
     {
 	if (c == BACKSLASH)
 	    fileGetc ();		/* throw away next character, too */
 	else if (c == NEWLINE)
 	    break;
+	fileSkipToCharacter ("\\\n");
     }
     return c;
 }
@@ -478,12 +484,14 @@ static int skipToEndOfString (void)
 {
     int c;
 
+    fileSkipToCharacter ("\\\"");
     while ((c = fileGetc ()) != EOF)
     {
 	if (c == BACKSLASH)
 	    fileGetc ();		/* throw away next character, too */
 	else if (c == DOUBLE_QUOTE)
 	    break;
+	fileSkipToCharacter ("\\\"");
     }
     return STRING_SYMBOL;		/* symbolic representation of string */
 }
@@ -650,4 +658,23 @@ process:
     return c;
 }
 
+/*  Skips characters which cppGetc () would return unchanged and which are
+ *  not among "stops", for a caller which would discard them. Any character
+ *  of significance to cppGetc () stops the skipping, as does the end of the
+ *  line, and nothing is skipped where a directive could yet begin.
+ */
+extern void cppSkipToCharacter (const char *const stops)
+{
+    static const char special [] = "\"'/\\#?\n";
+    char stopSet [sizeof (special) + MaxSkipStops];
+
+    Assert (strlen (stops) <= (size_t) MaxSkipStops);
+    if (Cpp.ungetch == '\0'  &&  ! Cpp.directive.accept)
+    {
+	strcpy (stopSet, special);
+	strcat (stopSet, stops);
+	fileSkipToCharacter (stopSet);
+    }
+}
+
 /* vi:set tabstop=8 shiftwidth=4: */
@@ -43,6 +43,7 @@ extern void cppBeginStatement (void);
 extern void cppEndStatement (void);
 extern void cppUngetc (const int c);
 extern int cppGetc (void);
+extern void cppSkipToCharacter (const char *const stops);
 
 #endif	/* _GET_H */
 
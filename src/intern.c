@@ -0,0 +1,192 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for interning strings which recur across
+*   many tags (file names, scope names, kind names). Each distinct string is
+*   stored once and identified by a small integer, which is resolved back to
+*   the string only when it is needed for output. Interned strings are never
+*   moved or freed until the program finishes.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+
+#include "debug.h"
+#include "intern.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define BLOCK_SIZE	65536	/* size of blocks holding strings */
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Strings are held in large blocks to avoid the overhead of allocating
+ *  each one separately.
+ */
+typedef struct sStringBlock {
+    struct sStringBlock *next;
+    size_t used;
+    size_t size;
+    char text [1];		/* actually `size' characters */
+} stringBlock;
+
+/*
+*   DATA DEFINITIONS
+*/
+static stringBlock *Blocks = NULL;
+
+static const char **Strings = NULL;	/* interned strings, by identifier */
+static unsigned int Count = 0;		/* identifiers used (including 0) */
+static unsigned int Space = 0;		/* allocated size of `Strings' */
+
+/*  Open hash table of identifiers (0 marks an unused slot).
+ */
+static unsigned int *Slots = NULL;
+static unsigned int SlotCount = 0;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static unsigned long hashString (const char *const string)
+{
+    unsigned long hash = 2166136261UL;
+    const unsigned char *p;
+
+    for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+    {
+	hash ^= *p;
+	hash = (hash * 16777619UL) & 0xffffffffUL;
+    }
+    return hash;
+}
+
+static unsigned int *findSlot (const char *const string)
+{
+    unsigned long i = hashString (string) & (SlotCount - 1);
+
+    while (Slots [i] != 0  &&  strcmp (Strings [Slots [i]], string) != 0)
+	i = (i + 1) & (SlotCount - 1);
+    return &Slots [i];
+}
+
+static void growSlots (void)
+{
+    unsigned int i;
+
+    if (Slots != NULL)
+	eFree (Slots);
+    SlotCount = (SlotCount == 0) ? 1024 : 2 * SlotCount;
+    Slots = xCalloc (SlotCount, unsigned int);
+    for (i = 1  ;  i < Count  ;  ++i)
+	*findSlot (Strings [i]) = i;
+}
+
+static const char *storeString (const char *const string)
+{
+    const size_t length = strlen (string) + 1;
+    char *result;
+
+    if (Blocks == NULL  ||  Blocks->size - Blocks->used < length)
+    {
+	const size_t size = (length > BLOCK_SIZE) ? length : BLOCK_SIZE;
+	stringBlock *const block = (stringBlock *)
+		eMalloc (sizeof (stringBlock) + size);
+	block->next = Blocks;
+	block->used = 0;
+	block->size = size;
+	Blocks = block;
+    }
+    result = Blocks->text + Blocks->used;
+    memcpy (result, string, length);
+    Blocks->used += length;
+    return result;
+}
+
+/*  Returns the identifier of a string, interning it if it has not been seen
+ *  before. The identifier of a null string is 0.
+ */
+extern unsigned int internString (const char *const string)
+{
+    unsigned int id = 0;
+
+    if (string != NULL)
+    {
+	unsigned int *slot;
+
+	if (2 * Count >= SlotCount)
+	    growSlots ();
+	slot = findSlot (string);
+	if (*slot != 0)
+	    id = *slot;
+	else
+	{
+	    if (Count == 0)
+		Count = 1;		/* 0 identifies the null string */
+	    if (Count >= Space)
+	    {
+		Space = (Space == 0) ? 1024 : 2 * Space;
+		Strings = xRealloc (Strings, Space, const char *);
+		Strings [0] = NULL;
+	    }
+	    id = Count++;
+	    Strings [id] = storeString (string);
+	    *slot = id;
+	}
+    }
+    return id;
+}
+
+/*  Returns the string having an identifier (NULL for 0).
+ */
+extern const char *internedString (const unsigned int id)
+{
+    Assert (id < Count  ||  id == 0);
+    return (id == 0) ? NULL : Strings [id];
+}
+
+/*  Returns a copy of a string which remains valid until the program ends.
+ */
+extern const char *internStringCopy (const char *const string)
+{
+    return internedString (internString (string));
+}
+
+/*  Returns one more than the largest identifier issued.
+ */
+extern unsigned int internedCount (void)
+{
+    return (Count == 0) ? 1 : Count;
+}
+
+extern void freeInternResources (void)
+{
+    while (Blocks != NULL)
+    {
+	stringBlock *const next = Blocks->next;
+	eFree (Blocks);
+	Blocks = next;
+    }
+    if (Strings != NULL)
+	eFree ((void *) Strings);
+    if (Slots != NULL)
+	eFree (Slots);
+    Strings = NULL;
+    Slots = NULL;
+    Count = Space = SlotCount = 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
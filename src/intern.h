@@ -0,0 +1,30 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to intern.c
+*/
+#ifndef _INTERN_H
+#define _INTERN_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern unsigned int internString (const char *const string);
+extern const char *internedString (const unsigned int id);
+extern const char *internStringCopy (const char *const string);
+extern unsigned int internedCount (void);
+extern void freeInternResources (void);
+
+#endif	/* _INTERN_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
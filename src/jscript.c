@@ -8,22 +8,1022 @@
 *
 *   This module contains functions for generating tags for JavaScript language
 *   files.
+*
+*   The source is read as a stream of tokens in a single pass. Functions are
+*   tagged where declared, and where a function expression or arrow function
+*   is assigned to a name or to an object property; classes and their methods
+*   are tagged as well. Minified code, recognized by the length of its lines,
+*   is not worth tagging and is skipped.
 */
 
 /*
 *   INCLUDE FILES
 */
 #include "general.h"	/* must always come first */
+
+#include <ctype.h>	/* to define isalpha () */
+#include <string.h>
+
+#include "debug.h"
+#include "entry.h"
+#include "keyword.h"
+#include "options.h"
 #include "parse.h"
+#include "read.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define isType(token,t)		(boolean) ((token)->type == (t))
+#define isKeyword(token,k)	(boolean) ((token)->keyword == (k))
+
+/*  A line longer than this is taken to be minified code; the rest of it is
+ *  skipped and nothing found on it is tagged.
+ */
+#define MAX_LINE_LENGTH		32768
+
+/*  Braces nested deeper than this are skipped without being parsed.
+ */
+#define MAX_BLOCK_DEPTH		256
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Used to specify type of keyword.
+ */
+typedef enum eKeywordId {
+    KEYWORD_NONE,
+    KEYWORD_class,
+    KEYWORD_function,
+    KEYWORD_operator		/* keyword after which an expression begins */
+} keywordId;
+
+/*  Used to determine whether keyword is valid for the token language and
+ *  what its ID is.
+ */
+typedef struct sKeywordDesc {
+    const char *name;
+    keywordId id;
+} keywordDesc;
+
+typedef enum eTokenType {
+    TOKEN_UNDEFINED,
+    TOKEN_EOF,
+    TOKEN_ARROW,
+    TOKEN_CLOSE_CURLY,
+    TOKEN_CLOSE_PAREN,
+    TOKEN_CLOSE_SQUARE,
+    TOKEN_COLON,
+    TOKEN_COMMA,
+    TOKEN_EQUAL_SIGN,
+    TOKEN_IDENTIFIER,
+    TOKEN_KEYWORD,
+    TOKEN_NUMBER,
+    TOKEN_OPEN_CURLY,
+    TOKEN_OPEN_PAREN,
+    TOKEN_OPEN_SQUARE,
+    TOKEN_OPERATOR,
+    TOKEN_PERIOD,
+    TOKEN_SEMICOLON,
+    TOKEN_STAR,
+    TOKEN_STRING
+} tokenType;
+
+typedef struct sTokenInfo {
+    tokenType	type;
+    keywordId	keyword;
+    vString *	string;
+    boolean	newLine;	/* is token first on its line? */
+    unsigned long lineNumber;	/* line number of token */
+    fpos_t	filePosition;	/* file position of line containing token */
+} tokenInfo;
+
+/*  What is awaited within a block.
+ */
+typedef enum eParseState {
+    STATE_NONE,
+    STATE_VALUE,		/* value assigned to candidate */
+    STATE_PARAMETERS,		/* parameters of an arrow function (maybe) */
+    STATE_ARROW,		/* "=>" of an arrow function */
+    STATE_FUNCTION,		/* name of function */
+    STATE_CLASS,		/* name of class declaration */
+    STATE_CLASS_HEAD		/* body of class */
+} parseState;
+
+typedef enum {
+    JSTAG_FUNCTION,
+    JSTAG_CLASS,
+    JSTAG_METHOD,
+    JSTAG_COUNT
+} jsKind;
+
+/*  State of parsing within one level of braces.
+ */
+typedef struct sBlockInfo {
+    unsigned int depth;		/* nesting level of braces */
+    boolean isClass;		/* is block the body of a class? */
+    const vString *className;	/* name of class, if known */
+    parseState state;
+    int parenDepth;		/* nesting of parentheses in parameters */
+    tokenType previous;		/* type of previous token in block */
+    tokenInfo *candidate;	/* name to tag if a function is assigned */
+    jsKind kind;		/* kind of tag for candidate */
+    vString *scope;		/* class of candidate, if known */
+    boolean named;		/* does candidate name the class awaited? */
+    tokenInfo *reference;	/* last name of a dotted reference */
+    vString *qualifier;		/* names preceding it in the reference */
+    tokenInfo *member;		/* possible name of class member */
+    boolean memberStart;	/* may a class member begin here? */
+} blockInfo;
+
+/*  A tag held back until the end of the line on which its name was found,
+ *  since the line may yet prove too long to be tagged.
+ */
+typedef struct sPendingTag {
+    vString *name;
+    jsKind kind;
+    vString *scope;		/* class of tag, if any */
+    unsigned long lineNumber;
+    fpos_t filePosition;
+} pendingTag;
+
+/*
+*   DATA DEFINITIONS
+*/
+
+static langType Lang_js;
+
+static tokenType LastTokenType;	/* type of last token read */
+static unsigned long LineLength;	/* characters read of current line */
+static unsigned long LineNumber;	/* line of last character read */
+static unsigned long LongLine;	/* last line found too long to tag */
+
+static pendingTag *Pending = NULL;	/* tags awaiting the end of their line */
+static unsigned int PendingCount = 0;
+static unsigned int PendingSpace = 0;
+
+static kindOption JsKinds [] = {
+    { TRUE,  'f', "function",  "functions"	},
+    { TRUE,  'c', "class",     "classes"	},
+    { TRUE,  'm', "method",    "methods"	}
+};
+
+static const keywordDesc JsKeywordTable [] = {
+    /* keyword		keyword ID */
+    { "await",		KEYWORD_operator	},
+    { "case",		KEYWORD_operator	},
+    { "class",		KEYWORD_class		},
+    { "delete",		KEYWORD_operator	},
+    { "do",		KEYWORD_operator	},
+    { "else",		KEYWORD_operator	},
+    { "function",	KEYWORD_function	},
+    { "in",		KEYWORD_operator	},
+    { "instanceof",	KEYWORD_operator	},
+    { "new",		KEYWORD_operator	},
+    { "return",		KEYWORD_operator	},
+    { "throw",		KEYWORD_operator	},
+    { "typeof",		KEYWORD_operator	},
+    { "void",		KEYWORD_operator	},
+    { "yield",		KEYWORD_operator	}
+};
 
 /*
 *   FUNCTION DEFINITIONS
 */
 
-static void installJavaScriptRegex (const langType language)
+static boolean isIdentChar1 (const int c)
+{
+    return (boolean)
+	(isalpha (c) || c == '$' || c == '_' || c == '#' || c >= 0x80);
+}
+
+static boolean isIdentChar (const int c)
+{
+    return (boolean) (isIdentChar1 (c) || isdigit (c));
+}
+
+static void buildJsKeywordHash (void)
+{
+    const size_t count = sizeof (JsKeywordTable) /
+			 sizeof (JsKeywordTable [0]);
+    size_t i;
+    for (i = 0  ;  i < count  ;  ++i)
+    {
+	const keywordDesc* const p = &JsKeywordTable [i];
+	addKeyword (p->name, Lang_js, (int) p->id);
+    }
+}
+
+static tokenInfo *newToken (void)
+{
+    tokenInfo *const token = xMalloc (1, tokenInfo);
+
+    token->type		= TOKEN_UNDEFINED;
+    token->keyword	= KEYWORD_NONE;
+    token->string	= vStringNew ();
+    token->newLine	= FALSE;
+    token->lineNumber	= 0L;
+
+    return token;
+}
+
+static void deleteToken (tokenInfo *const token)
+{
+    vStringDelete (token->string);
+    eFree (token);
+}
+
+static void copyToken (tokenInfo *const dest, const tokenInfo *const src)
+{
+    dest->type		= src->type;
+    dest->keyword	= src->keyword;
+    dest->newLine	= src->newLine;
+    dest->lineNumber	= src->lineNumber;
+    dest->filePosition	= src->filePosition;
+    vStringCopy (dest->string, src->string);
+}
+
+/*
+*   Tag generation functions
+*/
+
+/*  Holds back a tag for the name of "token" until its line is known not to
+ *  be too long.
+ */
+static void makeJsTag (const tokenInfo *const token, const jsKind kind,
+		       const vString *const scope)
+{
+    if (JsKinds [kind].enabled  &&  vStringLength (token->string) > 0  &&
+	token->lineNumber != LongLine)
+    {
+	pendingTag *tag;
+
+	if (PendingCount == PendingSpace)
+	{
+	    unsigned int i;
+
+	    PendingSpace = (PendingSpace == 0) ? 16 : 2 * PendingSpace;
+	    Pending = xRealloc (Pending, PendingSpace, pendingTag);
+	    for (i = PendingCount  ;  i < PendingSpace  ;  ++i)
+	    {
+		Pending [i].name  = vStringNew ();
+		Pending [i].scope = vStringNew ();
+	    }
+	}
+	tag = &Pending [PendingCount++];
+	vStringCopy (tag->name, token->string);
+	if (scope != NULL)
+	    vStringCopy (tag->scope, scope);
+	else
+	    vStringClear (tag->scope);
+	tag->kind		= kind;
+	tag->lineNumber		= token->lineNumber;
+	tag->filePosition	= token->filePosition;
+    }
+}
+
+/*  Makes the tags held back, except those for names found on a line which
+ *  proved too long.
+ */
+static void flushJsTags (void)
+{
+    unsigned int i;
+
+    for (i = 0  ;  i < PendingCount  ;  ++i)
+    {
+	const pendingTag *const tag = &Pending [i];
+
+	if (tag->lineNumber != LongLine)
+	{
+	    tagEntryInfo e;
+	    initTagEntry (&e, vStringValue (tag->name));
+
+	    e.lineNumber	= tag->lineNumber;
+	    e.filePosition	= tag->filePosition;
+	    e.kindName		= JsKinds [tag->kind].name;
+	    e.kind		= JsKinds [tag->kind].letter;
+	    if (vStringLength (tag->scope) > 0)
+	    {
+		e.extensionFields.scope [0] = JsKinds [JSTAG_CLASS].name;
+		e.extensionFields.scope [1] = vStringValue (tag->scope);
+	    }
+	    makeTagEntry (&e);
+	}
+    }
+    PendingCount = 0;
+}
+
+static void deletePendingTags (void)
+{
+    unsigned int i;
+
+    for (i = 0  ;  i < PendingSpace  ;  ++i)
+    {
+	vStringDelete (Pending [i].name);
+	vStringDelete (Pending [i].scope);
+    }
+    if (Pending != NULL)
+	eFree (Pending);
+    Pending = NULL;
+    PendingCount = 0;
+    PendingSpace = 0;
+}
+
+/*
+*   Character reading functions
+*/
+
+/*  Reads the next character. Once a line has grown too long to be anything
+ *  but minified code, the rest of it is skipped, and the tags held back for
+ *  names found on it are dropped. Otherwise they are made at its end.
+ *
+ *  Lines are counted here rather than read from File, which is declared
+ *  const outside of read.c, so that an optimizing compiler may keep a value
+ *  of File.source.lineNumber loaded before a loop of calls to this function.
+ */
+static int jsGetc (void)
+{
+    int c = fileGetc ();
+
+    if (c == '\n')
+    {
+	++LineNumber;
+	LineLength = 0;
+	flushJsTags ();
+    }
+    else if (c != EOF  &&  ++LineLength > MAX_LINE_LENGTH)
+    {
+	verbose ("%s: skipping minified line %lu\n",
+		getInputFileName (), LineNumber);
+	LongLine = LineNumber;
+	flushJsTags ();
+	fileSkipToCharacter ("\n");
+	c = fileGetc ();
+	if (c == '\n')
+	    ++LineNumber;
+	LineLength = 0;
+    }
+    return c;
+}
+
+static void jsUngetc (const int c)
+{
+    if (c != EOF)
+    {
+	fileUngetc (c);
+	if (c == '\n')
+	    --LineNumber;
+	else
+	    --LineLength;
+    }
+}
+
+/*  Is the file minified, judging by the length of its first line? Such a
+ *  file is not read at all, rather than read as one enormous line.
+ */
+static boolean isMinifiedFile (void)
+{
+    static char prefix [MAX_LINE_LENGTH + 1];
+    const size_t length = filePeek (prefix, sizeof (prefix));
+
+    return (boolean) (length == sizeof (prefix)  &&
+		      memchr (prefix, '\n', length) == NULL  &&
+		      memchr (prefix, '\r', length) == NULL);
+}
+
+static void skipToNewline (void)
+{
+    int c;
+    do
+	c = jsGetc ();
+    while (c != EOF  &&  c != '\n');
+}
+
+/*  Skips a comment, returning whether a line was ended within it.
+ */
+static boolean skipComment (void)
+{
+    boolean newLine = FALSE;
+    int c = jsGetc ();
+
+    while (c != EOF)
+    {
+	if (c == '\n')
+	    newLine = TRUE;
+	if (c != '*')
+	    c = jsGetc ();
+	else
+	{
+	    c = jsGetc ();
+	    if (c == '/')
+		break;
+	}
+    }
+    return newLine;
+}
+
+static void skipString (const int delimiter)
+{
+    int c = jsGetc ();
+    while (c != EOF  &&  c != delimiter)
+    {
+	if (c == '\\')
+	    jsGetc ();		/* throw away next character, too */
+	else if (c == '\n')
+	{
+	    jsUngetc (c);	/* string not terminated */
+	    break;
+	}
+	c = jsGetc ();
+    }
+}
+
+static void readToken (tokenInfo *const token);
+
+/*  Skips an expression embedded in a template string, whose "${" has been
+ *  read. The expression is read as tokens, since it may itself hold strings,
+ *  templates and regular expressions.
+ */
+static void skipTemplateExpression (void)
+{
+    tokenInfo *const token = newToken ();
+    int depth = 1;
+
+    LastTokenType = TOKEN_OPEN_CURLY;
+    do
+    {
+	readToken (token);
+	if (isType (token, TOKEN_OPEN_CURLY))
+	    ++depth;
+	else if (isType (token, TOKEN_CLOSE_CURLY))
+	    --depth;
+    } while (depth > 0  &&  ! isType (token, TOKEN_EOF));
+    deleteToken (token);
+}
+
+static void skipTemplate (void)
+{
+    int c = jsGetc ();
+    while (c != EOF  &&  c != '`')
+    {
+	if (c == '\\')
+	    jsGetc ();		/* throw away next character, too */
+	else if (c == '$')
+	{
+	    c = jsGetc ();
+	    if (c == '{')
+		skipTemplateExpression ();
+	    else
+		continue;
+	}
+	c = jsGetc ();
+    }
+}
+
+static void skipRegularExpression (void)
+{
+    boolean inClass = FALSE;
+    int c = jsGetc ();
+    while (c != EOF  &&  (c != '/'  ||  inClass))
+    {
+	if (c == '\\')
+	    jsGetc ();		/* throw away next character, too */
+	else if (c == '[')
+	    inClass = TRUE;
+	else if (c == ']')
+	    inClass = FALSE;
+	else if (c == '\n')
+	{
+	    jsUngetc (c);	/* not a regular expression after all */
+	    break;
+	}
+	c = jsGetc ();
+    }
+}
+
+/*  Can a regular expression begin after the last token, rather than a
+ *  division operator?
+ */
+static boolean isRegexAllowed (void)
+{
+    switch (LastTokenType)
+    {
+	case TOKEN_CLOSE_CURLY:
+	case TOKEN_CLOSE_PAREN:
+	case TOKEN_CLOSE_SQUARE:
+	case TOKEN_IDENTIFIER:
+	case TOKEN_NUMBER:
+	case TOKEN_STRING:
+	    return FALSE;
+	default:
+	    return TRUE;
+    }
+}
+
+static void parseIdentifier (vString *const string, const int firstChar)
+{
+    int c = firstChar;
+    Assert (isIdentChar1 (c));
+    do
+    {
+	vStringPut (string, c);
+	c = jsGetc ();
+    } while (isIdentChar (c));
+    vStringTerminate (string);
+    jsUngetc (c);		/* unget non-identifier character */
+}
+
+static void readOperator (tokenInfo *const token)
+{
+    int c;
+    do
+	c = jsGetc ();
+    while (c == '=');
+    jsUngetc (c);
+    token->type = TOKEN_OPERATOR;
+}
+
+static void readToken (tokenInfo *const token)
+{
+    int c;
+
+    token->type		= TOKEN_UNDEFINED;
+    token->keyword	= KEYWORD_NONE;
+    token->newLine	= FALSE;
+    vStringClear (token->string);
+
+getNextChar:
+    do
+    {
+	c = jsGetc ();
+	if (c == '\n')
+	    token->newLine = TRUE;
+    } while (isspace (c));
+
+    token->lineNumber	= LineNumber;
+    token->filePosition	= getInputFilePosition ();
+
+    switch (c)
+    {
+	case EOF: token->type = TOKEN_EOF;			break;
+	case '(': token->type = TOKEN_OPEN_PAREN;		break;
+	case ')': token->type = TOKEN_CLOSE_PAREN;		break;
+	case '[': token->type = TOKEN_OPEN_SQUARE;		break;
+	case ']': token->type = TOKEN_CLOSE_SQUARE;		break;
+	case '{': token->type = TOKEN_OPEN_CURLY;		break;
+	case '}': token->type = TOKEN_CLOSE_CURLY;		break;
+	case ';': token->type = TOKEN_SEMICOLON;		break;
+	case ',': token->type = TOKEN_COMMA;			break;
+	case ':': token->type = TOKEN_COLON;			break;
+	case '.': token->type = TOKEN_PERIOD;			break;
+
+	case '\'':
+	case '"':
+	    token->type = TOKEN_STRING;
+	    skipString (c);
+	    break;
+
+	case '`':
+	    token->type = TOKEN_STRING;
+	    skipTemplate ();
+	    break;
+
+	case '=':
+	{
+	    const int d = jsGetc ();
+	    if (d == '>')
+		token->type = TOKEN_ARROW;
+	    else if (d == '=')
+		readOperator (token);
+	    else
+	    {
+		jsUngetc (d);
+		token->type = TOKEN_EQUAL_SIGN;
+	    }
+	    break;
+	}
+
+	case '*':
+	{
+	    const int d = jsGetc ();
+	    if (d == '=')
+		token->type = TOKEN_OPERATOR;
+	    else
+	    {
+		jsUngetc (d);
+		token->type = TOKEN_STAR;
+	    }
+	    break;
+	}
+
+	case '/':
+	{
+	    const int d = jsGetc ();
+	    if (d == '/')		/* is this the start of a comment? */
+	    {
+		skipToNewline ();
+		token->newLine = TRUE;
+		goto getNextChar;
+	    }
+	    else if (d == '*')
+	    {
+		if (skipComment ())
+		    token->newLine = TRUE;
+		goto getNextChar;
+	    }
+	    jsUngetc (d);
+	    if (isRegexAllowed ())
+	    {
+		token->type = TOKEN_STRING;
+		skipRegularExpression ();
+	    }
+	    else
+		readOperator (token);
+	    break;
+	}
+
+	default:
+	    if (isIdentChar1 (c))
+	    {
+		parseIdentifier (token->string, c);
+		if (LastTokenType != TOKEN_PERIOD)	/* not a property */
+		    token->keyword = (keywordId)
+			    lookupKeyword (vStringValue (token->string), Lang_js);
+		if (isKeyword (token, KEYWORD_NONE))
+		    token->type = TOKEN_IDENTIFIER;
+		else
+		    token->type = TOKEN_KEYWORD;
+	    }
+	    else if (isdigit (c))
+	    {
+		do
+		    c = jsGetc ();
+		while (isIdentChar (c)  ||  c == '.');
+		jsUngetc (c);
+		token->type = TOKEN_NUMBER;
+	    }
+	    else
+		readOperator (token);
+	    break;
+    }
+    LastTokenType = token->type;
+}
+
+/*
+*   Parsing functions
+*/
+
+static void initBlock (blockInfo *const block, const unsigned int depth,
+		       const boolean isClass, const vString *const className)
+{
+    block->depth	= depth;
+    block->isClass	= isClass;
+    block->className	= className;
+    block->state	= STATE_NONE;
+    block->parenDepth	= 0;
+    block->previous	= TOKEN_UNDEFINED;
+    block->candidate	= newToken ();
+    block->kind		= JSTAG_FUNCTION;
+    block->scope	= vStringNew ();
+    block->named	= FALSE;
+    block->reference	= newToken ();
+    block->qualifier	= vStringNew ();
+    block->member	= newToken ();
+    block->memberStart	= TRUE;
+}
+
+static void deleteBlock (blockInfo *const block)
+{
+    deleteToken (block->candidate);
+    vStringDelete (block->scope);
+    deleteToken (block->reference);
+    vStringDelete (block->qualifier);
+    deleteToken (block->member);
+}
+
+static boolean isNamed (const tokenInfo *const token, const char *const name)
+{
+    return (boolean) (isType (token, TOKEN_IDENTIFIER)  &&
+		      strcmp (vStringValue (token->string), name) == 0);
+}
+
+/*  Takes the reference just read as the candidate for a tag, should a
+ *  function be assigned to it. A function assigned to a prototype, or to a
+ *  name within the body of a class, is a method of that class.
+ */
+static void beginValue (blockInfo *const block, const boolean isProperty)
+{
+    static const char prototype [] = ".prototype";
+    const size_t prototypeLength = sizeof (prototype) - 1;
+    const char *const qualifier = vStringValue (block->qualifier);
+    const size_t length = vStringLength (block->qualifier);
+
+    copyToken (block->candidate, block->reference);
+    vStringClear (block->scope);
+    if (isProperty)
+	block->kind = JSTAG_METHOD;
+    else if (length == 0)
+    {
+	if (! block->isClass)
+	    block->kind = JSTAG_FUNCTION;
+	else
+	{
+	    block->kind = JSTAG_METHOD;
+	    if (block->className != NULL)
+		vStringCopy (block->scope, block->className);
+	}
+    }
+    else if (strcmp (qualifier, "this") == 0)
+	block->kind = JSTAG_METHOD;
+    else if (length > prototypeLength  &&
+	     strcmp (qualifier + length - prototypeLength, prototype) == 0)
+    {
+	block->kind = JSTAG_METHOD;
+	vStringNCopyS (block->scope, qualifier, length - prototypeLength);
+    }
+    else
+	block->kind = JSTAG_FUNCTION;
+    block->state = STATE_VALUE;
+}
+
+/*  Advances the state of the block upon reading a token, returning whether
+ *  the token was consumed by the state.
+ */
+static boolean advanceState (blockInfo *const block,
+			     const tokenInfo *const token)
+{
+    boolean used = TRUE;
+
+    switch (block->state)
+    {
+	case STATE_NONE:
+	    used = FALSE;
+	    break;
+
+	case STATE_VALUE:
+	    if (isKeyword (token, KEYWORD_function))
+	    {
+		makeJsTag (block->candidate, block->kind, block->scope);
+		block->state = STATE_FUNCTION;
+	    }
+	    else if (isKeyword (token, KEYWORD_class))
+	    {
+		makeJsTag (block->candidate, JSTAG_CLASS, NULL);
+		block->named = TRUE;
+		block->state = STATE_CLASS_HEAD;
+	    }
+	    else if (isType (token, TOKEN_OPEN_PAREN))
+	    {
+		block->parenDepth = 1;
+		block->state = STATE_PARAMETERS;
+	    }
+	    else if (isType (token, TOKEN_IDENTIFIER))
+	    {
+		if (! isNamed (token, "async"))
+		    block->state = STATE_ARROW;
+	    }
+	    else
+	    {
+		block->state = STATE_NONE;
+		used = FALSE;
+	    }
+	    break;
+
+	case STATE_PARAMETERS:
+	    if (isType (token, TOKEN_OPEN_PAREN))
+		++block->parenDepth;
+	    else if (isType (token, TOKEN_CLOSE_PAREN))
+	    {
+		if (--block->parenDepth == 0)
+		    block->state = STATE_ARROW;
+	    }
+	    else if (isType (token, TOKEN_KEYWORD)  ||
+		     isType (token, TOKEN_SEMICOLON))
+	    {
+		block->state = STATE_NONE;
+		used = FALSE;
+	    }
+	    break;
+
+	case STATE_ARROW:
+	    block->state = STATE_NONE;
+	    if (isType (token, TOKEN_ARROW))
+		makeJsTag (block->candidate, block->kind, block->scope);
+	    else
+		used = FALSE;
+	    break;
+
+	case STATE_FUNCTION:
+	    if (! isType (token, TOKEN_STAR))
+	    {
+		block->state = STATE_NONE;
+		if (isType (token, TOKEN_IDENTIFIER))
+		    makeJsTag (token, JSTAG_FUNCTION, NULL);
+		else
+		    used = FALSE;
+	    }
+	    break;
+
+	case STATE_CLASS:
+	    block->state = STATE_CLASS_HEAD;
+	    if (isType (token, TOKEN_IDENTIFIER)  &&  ! isNamed (token, "extends"))
+	    {
+		copyToken (block->candidate, token);
+		makeJsTag (block->candidate, JSTAG_CLASS, NULL);
+		block->named = TRUE;
+	    }
+	    break;
+
+	case STATE_CLASS_HEAD:
+	    if (isType (token, TOKEN_SEMICOLON))
+		block->state = STATE_NONE;
+	    break;
+    }
+    return used;
+}
+
+/*  Keeps the last dotted reference read (e.g. "Foo.prototype.bar"), which
+ *  becomes the candidate for a tag when followed by an assignment, or by a
+ *  colon within an object literal.
+ */
+static void trackReference (blockInfo *const block,
+			    const tokenInfo *const token)
+{
+    if (isType (token, TOKEN_IDENTIFIER))
+    {
+	if (block->previous != TOKEN_PERIOD)
+	    vStringClear (block->qualifier);
+	else if (vStringLength (block->reference->string) > 0)
+	{
+	    if (vStringLength (block->qualifier) > 0)
+		vStringPut (block->qualifier, '.');
+	    vStringCat (block->qualifier, block->reference->string);
+	}
+	copyToken (block->reference, token);
+    }
+    else if (! isType (token, TOKEN_PERIOD))
+    {
+	if (block->state == STATE_NONE  &&
+	    block->previous == TOKEN_IDENTIFIER  &&
+	    vStringLength (block->reference->string) > 0)
+	{
+	    if (isType (token, TOKEN_EQUAL_SIGN))
+		beginValue (block, FALSE);
+	    else if (isType (token, TOKEN_COLON)  &&  block->depth > 0  &&
+		     ! block->isClass  &&  vStringLength (block->qualifier) == 0)
+		beginValue (block, TRUE);
+	}
+	vStringClear (block->reference->string);
+	vStringClear (block->qualifier);
+    }
+}
+
+static boolean isMemberModifier (const tokenInfo *const token)
+{
+    return (boolean) (isNamed (token, "static")  ||  isNamed (token, "async") ||
+		      isNamed (token, "get")  ||  isNamed (token, "set"));
+}
+
+/*  Finds the methods declared within the body of a class: a name, after any
+ *  modifiers, followed by a parameter list, at the start of a member.
+ */
+static void findMember (blockInfo *const block, const tokenInfo *const token)
 {
-    addTagRegex (language, "^[ \t]*function[ \t]*([A-Za-z0-9_]+)[ \t]*\\(",
-	    "\\1", "f,function,functions", NULL);
+    const boolean start = (boolean) (block->memberStart  ||  token->newLine);
+
+    if (start  &&  (isType (token, TOKEN_IDENTIFIER)  ||
+		    isKeyword (token, KEYWORD_operator)))
+    {
+	copyToken (block->member, token);
+	block->memberStart = isMemberModifier (token);
+    }
+    else if (start  &&  isType (token, TOKEN_STAR))
+    {
+	vStringClear (block->member->string);
+	block->memberStart = TRUE;
+    }
+    else
+    {
+	if (isType (token, TOKEN_OPEN_PAREN))
+	    makeJsTag (block->member, JSTAG_METHOD, block->className);
+	vStringClear (block->member->string);
+	block->memberStart = isType (token, TOKEN_SEMICOLON);
+    }
+}
+
+static void processToken (blockInfo *const block, const tokenInfo *const token)
+{
+    if (! advanceState (block, token)  &&  block->state == STATE_NONE)
+    {
+	if (isKeyword (token, KEYWORD_function))
+	    block->state = STATE_FUNCTION;
+	else if (isKeyword (token, KEYWORD_class))
+	{
+	    block->state = STATE_CLASS;
+	    block->named = FALSE;
+	}
+    }
+    trackReference (block, token);
+    if (block->isClass)
+	findMember (block, token);
+}
+
+static void skipBlock (tokenInfo *const token)
+{
+    int depth = 1;
+    do
+    {
+	readToken (token);
+	if (isType (token, TOKEN_OPEN_CURLY))
+	    ++depth;
+	else if (isType (token, TOKEN_CLOSE_CURLY))
+	    --depth;
+    } while (depth > 0  &&  ! isType (token, TOKEN_EOF));
+}
+
+/*  Parses the tokens within a level of braces, up to and including the
+ *  closing brace (or the end of the file, at the outermost level).
+ */
+static void parseBlock (tokenInfo *const token, const unsigned int depth,
+			const boolean isClass, const vString *const className)
+{
+    blockInfo block;
+    boolean done = FALSE;
+
+    initBlock (&block, depth, isClass, className);
+    while (! done)
+    {
+	readToken (token);
+	switch (token->type)
+	{
+	    case TOKEN_EOF:
+		done = TRUE;
+		break;
+
+	    case TOKEN_CLOSE_CURLY:
+		done = (boolean) (depth > 0);
+		break;
+
+	    case TOKEN_OPEN_CURLY:
+		if (depth + 1 >= MAX_BLOCK_DEPTH)
+		    skipBlock (token);
+		else if (block.state == STATE_CLASS  ||
+			 block.state == STATE_CLASS_HEAD)
+		{
+		    parseBlock (token, depth + 1, TRUE,
+				block.named ? block.candidate->string : NULL);
+		}
+		else
+		    parseBlock (token, depth + 1, FALSE, NULL);
+		done = isType (token, TOKEN_EOF);
+		block.state = STATE_NONE;
+		block.memberStart = TRUE;
+		vStringClear (block.reference->string);
+		vStringClear (block.member->string);
+		break;
+
+	    default:
+		processToken (&block, token);
+		break;
+	}
+	block.previous = token->type;
+    }
+    deleteBlock (&block);
+}
+
+static void initialize (const langType language)
+{
+    Assert (sizeof (JsKinds) / sizeof (JsKinds [0]) == JSTAG_COUNT);
+    Lang_js = language;
+    buildJsKeywordHash ();
+}
+
+static void findJsTags (void)
+{
+    tokenInfo *const token = newToken ();
+
+    LastTokenType = TOKEN_UNDEFINED;
+    LineLength = 0;
+    LineNumber = 1;
+    LongLine = 0;
+    if (isMinifiedFile ())
+	verbose ("%s: first line too long; taken to be minified\n",
+		getInputFileName ());
+    else
+    {
+	const int c = jsGetc ();
+	if (c == '#')		/* "#!" line of a script */
+	    skipToNewline ();
+	else
+	    jsUngetc (c);
+	parseBlock (token, 0, FALSE, NULL);
+	flushJsTags ();
+    }
+    deletePendingTags ();
+    deleteToken (token);
 }
 
 /* Create parser definition stucture */
@@ -31,8 +1031,12 @@ extern parserDefinition* JavaScriptParser (void)
 {
     static const char *const extensions [] = { "js", NULL };
     parserDefinition *const def = parserNew ("JavaScript");
+    def->kinds      = JsKinds;
+    def->kindCount  = KIND_COUNT (JsKinds);
     def->extensions = extensions;
-    def->initialize = installJavaScriptRegex;
-    def->regex      = TRUE;
+    def->parser     = findJsTags;
+    def->initialize = initialize;
     return def;
 }
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -192,6 +192,34 @@ extern void freeKeywordTable (void)
     }
 }
 
+/*  Reports the number of keywords in the table, the number of hash buckets
+ *  in use and the length of the longest chain.
+ */
+extern void getKeywordTableStatistics (unsigned long *const keywords,
+				       unsigned int *const usedBuckets,
+				       unsigned int *const longestChain)
+{
+    hashEntry **const table = getHashTable ();
+    unsigned int i;
+
+    *keywords = 0;
+    *usedBuckets = 0;
+    *longestChain = 0;
+    for (i = 0  ;  i < TableSize  ;  ++i)
+    {
+	const hashEntry *entry;
+	unsigned int length = 0;
+
+	for (entry = table [i]  ;  entry != NULL  ;  entry = entry->next)
+	    ++length;
+	*keywords += length;
+	if (length > 0)
+	    ++*usedBuckets;
+	if (length > *longestChain)
+	    *longestChain = length;
+    }
+}
+
 #ifdef DEBUG
 
 static void printEntry (const hashEntry *const entry)
@@ -24,6 +24,7 @@
 extern void addKeyword (const char *const string, langType language, int value);
 extern int lookupKeyword (const char *const string, langType language);
 extern void freeKeywordTable (void);
+extern void getKeywordTableStatistics (unsigned long *const keywords, unsigned int *const usedBuckets, unsigned int *const longestChain);
 #ifdef DEBUG
 extern void printKeywordTable (void);
 #endif
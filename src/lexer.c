@@ -0,0 +1,102 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions shared by the token-based parsers: tables
+*   classifying characters, from which runs of characters are read in bulk by
+*   fileGetSpan (), lookup of keywords regardless of case, and pools through
+*   which token objects are reused instead of being allocated for each token.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include "debug.h"
+#include "keyword.h"
+#include "lexer.h"
+#include "routines.h"
+
+/*
+*   DATA DEFINITIONS
+*/
+static vString *Folded = NULL;	/* lower case copy of looked up name */
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Adds "classes" to the class of each character of "chars".
+ */
+extern void lexSetClass (lexClassTable table, const char *const chars,
+			 const int classes)
+{
+    const unsigned char *p;
+
+    for (p = (const unsigned char *) chars  ;  *p != '\0'  ;  ++p)
+	table [*p] |= (unsigned char) classes;
+}
+
+/*  Looks up a name among the keywords of a language whose keywords are not
+ *  sensitive to case (the keywords themselves being added in lower case).
+ */
+extern int lexLookupKeyword (const vString *const name,
+			     const langType language)
+{
+    if (Folded == NULL)
+	Folded = vStringNew ();
+    vStringCopyToLower (Folded, name);
+    return lookupKeyword (vStringValue (Folded), language);
+}
+
+extern lexPool *lexPoolNew (void (*destroy) (void *object))
+{
+    lexPool *const pool = xMalloc (1, lexPool);
+
+    pool->objects = NULL;
+    pool->count   = 0;
+    pool->space   = 0;
+    pool->destroy = destroy;
+
+    return pool;
+}
+
+/*  Returns an object released to the pool, or NULL if the pool is empty.
+ */
+extern void *lexPoolGet (lexPool *const pool)
+{
+    void *result = NULL;
+
+    if (pool->count > 0)
+	result = pool->objects [--pool->count];
+    return result;
+}
+
+extern void lexPoolPut (lexPool *const pool, void *const object)
+{
+    Assert (object != NULL);
+    if (pool->count == pool->space)
+    {
+	pool->space = (pool->space == 0) ? 16 : 2 * pool->space;
+	pool->objects = xRealloc (pool->objects, pool->space, void *);
+    }
+    pool->objects [pool->count++] = object;
+}
+
+extern void lexPoolDelete (lexPool *const pool)
+{
+    unsigned int i;
+
+    for (i = 0  ;  i < pool->count  ;  ++i)
+	pool->destroy (pool->objects [i]);
+    if (pool->objects != NULL)
+	eFree (pool->objects);
+    eFree (pool);
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,70 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to lexer.c
+*/
+#ifndef _LEXER_H
+#define _LEXER_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>	/* to declare EOF */
+
+#include "parse.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+
+/*  Character classes common to the token-based parsers. The remaining bits
+ *  of a class table are free for classes of a parser's own.
+ */
+#define LEX_SPACE	0x01	/* white space between tokens */
+#define LEX_IDENT_START	0x02	/* character which may begin an identifier */
+#define LEX_IDENT	0x04	/* character which may continue an identifier */
+#define LEX_DIGIT	0x08	/* character which may begin a number */
+
+#define LEX_LETTERS	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+#define LEX_DIGITS	"0123456789"
+
+/*  Is character "c" (which may be EOF) in any of classes "k" of "table"?
+ */
+#define lexIsClass(table,c,k) \
+	((c) != EOF  &&  ((table) [(unsigned char) (c)] & (k)) != 0)
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef unsigned char lexClassTable [256];
+
+/*  A pool of released token objects, reused in place of allocating new ones.
+ */
+typedef struct sLexPool {
+    void **objects;
+    unsigned int count;
+    unsigned int space;
+    void (*destroy) (void *object);	/* frees an object left in the pool */
+} lexPool;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void lexSetClass (lexClassTable table, const char *const chars, const int classes);
+extern int lexLookupKeyword (const vString *const name, const langType language);
+extern lexPool *lexPoolNew (void (*destroy) (void *object));
+extern void *lexPoolGet (lexPool *const pool);
+extern void lexPoolPut (lexPool *const pool, void *const object);
+extern void lexPoolDelete (lexPool *const pool);
+
+#endif	/* _LEXER_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
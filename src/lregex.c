@@ -67,6 +67,8 @@ enum pType { PTRN_TAG, PTRN_CALLBACK };
 typedef struct {
     regex_t *pattern;
     enum pType type;
+    const char *literal;	/* string any match contains, or NULL */
+    boolean active;		/* might match in current file? */
     union {
 	struct {
 	    char *name_pattern;
@@ -83,6 +85,7 @@ typedef struct {
 typedef struct {
     regexPattern *patterns;
     unsigned int count;
+    unsigned int active;	/* count of active patterns */
 } patternSet;
 
 /*
@@ -95,13 +98,16 @@ static boolean regexBroken = FALSE;
 static patternSet* Sets = NULL;
 static int SetUpper = -1;	/* upper language index in list */
 
+/* Language whose patterns were last filtered for the current file */
+static langType Filtered = LANG_IGNORE;
+
 /*
 *   FUNCTION DEFINITIONS
 */
 
 static void clearPatternSet (const langType language)
 {
-    if (language < SetUpper)
+    if (language <= SetUpper)
     {
 	patternSet* const set = Sets + language;
 	unsigned int i;
@@ -123,6 +129,7 @@ static void clearPatternSet (const langType language)
 	    eFree (set->patterns);
 	set->patterns = NULL;
 	set->count = 0;
+	set->active = 0;
     }
 }
 
@@ -258,6 +265,7 @@ static void addCompiledTagPattern (
 	{
 	    Sets [i].patterns = NULL;
 	    Sets [i].count = 0;
+	    Sets [i].active = 0;
 	}
 	SetUpper = language;
     }
@@ -265,8 +273,11 @@ static void addCompiledTagPattern (
     set->patterns = xRealloc (set->patterns, (set->count + 1), regexPattern);
     ptrn = &set->patterns [set->count];
     set->count += 1;
+    set->active += 1;
 
     ptrn->pattern = pattern;
+    ptrn->literal = regmust (pattern);
+    ptrn->active  = TRUE;
     ptrn->type    = PTRN_TAG;
     ptrn->u.tag.name_pattern = name;
     ptrn->u.tag.kind.enabled = TRUE;
@@ -289,6 +300,7 @@ static void addCompiledCallbackPattern (
 	{
 	    Sets [i].patterns = NULL;
 	    Sets [i].count = 0;
+	    Sets [i].active = 0;
 	}
 	SetUpper = language;
     }
@@ -296,8 +308,11 @@ static void addCompiledCallbackPattern (
     set->patterns = xRealloc (set->patterns, (set->count + 1), regexPattern);
     ptrn = &set->patterns [set->count];
     set->count += 1;
+    set->active += 1;
 
     ptrn->pattern = pattern;
+    ptrn->literal = regmust (pattern);
+    ptrn->active  = TRUE;
     ptrn->type    = PTRN_CALLBACK;
     ptrn->u.callback.function = callback;
 }
@@ -490,6 +505,27 @@ static void matchCallbackPattern (
     patbuf->u.callback.function (vStringValue (line), matches, count);
 }
 
+/* Does "text", which may include null characters, contain "string"? */
+static boolean containsString (const char *const text, const size_t length,
+			       const char *const string)
+{
+    const size_t stringLength = strlen (string);
+    const char *const end = text + length;
+    const char *p = text;
+    boolean result = (boolean) (stringLength == 0);
+
+    while (! result  &&  (size_t) (end - p) >= stringLength  &&
+	   (p = memchr (p, string [0], (size_t) (end - p) - stringLength + 1))
+		!= NULL)
+    {
+	if (memcmp (p, string, stringLength) == 0)
+	    result = TRUE;
+	else
+	    ++p;
+    }
+    return result;
+}
+
 static boolean matchRegexPattern (const vString* const line,
 	const regexPattern* const patbuf)
 {
@@ -520,7 +556,8 @@ static boolean matchRegexPattern (const vString* const line,
 /* PUBLIC INTERFACE */
 
 /* Match against all patterns for specified language. Returns true if at least
- * on pattern matched.
+ * on pattern matched. Patterns found by prefilterRegex () unable to match
+ * anywhere in the current file are passed over.
  */
 extern boolean matchRegex (const vString* const line, const langType language)
 {
@@ -529,14 +566,77 @@ extern boolean matchRegex (const vString* const line, const langType language)
 	Sets [language].count > 0)
     {
 	const patternSet* const set = Sets + language;
+	const boolean filtered = (boolean) (language == Filtered);
 	unsigned int i;
-	for (i = 0  ;  i < set->count  ;  ++i)
-	    if (matchRegexPattern (line, set->patterns + i))
-		result = TRUE;
+	if (! filtered  ||  set->active > 0)
+	{
+	    for (i = 0  ;  i < set->count  ;  ++i)
+		if ((! filtered  ||  set->patterns [i].active)  &&
+		    matchRegexPattern (line, set->patterns + i))
+		    result = TRUE;
+	}
     }
     return result;
 }
 
+/* Activates each pattern of a set whose required literal string is found in
+ * a chunk of the input file, returning whether any remains to be found.
+ */
+static boolean scanForLiterals (const char *const chunk, const size_t length,
+				void *const data)
+{
+    patternSet* const set = (patternSet*) data;
+    boolean missing = FALSE;
+    unsigned int i;
+
+    for (i = 0  ;  i < set->count  ;  ++i)
+    {
+	regexPattern* const ptrn = set->patterns + i;
+	if (! ptrn->active)
+	{
+	    if (containsString (chunk, length, ptrn->literal))
+	    {
+		ptrn->active = TRUE;
+		++set->active;
+	    }
+	    else
+		missing = TRUE;
+	}
+    }
+    return missing;
+}
+
+/* Looks through the input file, before it is read, for the literal string
+ * each pattern of the language requires, and deactivates for this file each
+ * pattern whose string is absent. The file is searched in chunks, stopping
+ * once every string has been found, instead of every line being tried
+ * against these patterns.
+ */
+extern void prefilterRegex (const langType language)
+{
+    Filtered = language;
+    if (language != LANG_IGNORE  &&  language <= SetUpper  &&
+	Sets [language].count > 0)
+    {
+	patternSet* const set = Sets + language;
+	size_t overlap = 0;
+	unsigned int i;
+
+	set->active = 0;
+	for (i = 0  ;  i < set->count  ;  ++i)
+	{
+	    regexPattern* const ptrn = set->patterns + i;
+	    ptrn->active = (boolean) (ptrn->literal == NULL);
+	    if (ptrn->active)
+		++set->active;
+	    else if (strlen (ptrn->literal) > overlap + 1)
+		overlap = strlen (ptrn->literal) - 1;
+	}
+	if (set->active < set->count)
+	    fileScan (overlap, scanForLiterals, set);
+    }
+}
+
 extern void findRegexTags (void)
 {
     /* merely read all lines of the file */
@@ -623,7 +723,10 @@ extern boolean processRegexOption (const char *const option,
 	if (language == LANG_IGNORE)
 	    error (WARNING, "unknown language in --%s option", option);
 	else
+	{
+	    initializeParser (language);	/* built-in patterns come first */
 	    processLanguageRegex (language, parameter);
+	}
 #else
 	error (WARNING, "regex support not available; required for --%s option",
 	   option);
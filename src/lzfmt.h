@@ -0,0 +1,73 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released into the public domain.
+*
+*   Defines the layout of the compressed tag file written by lztags.c
+*   (--compress option) and read by readtags.c.
+*
+*   The file holds the lines of an ordinary tag file, divided at line
+*   boundaries into blocks which are compressed independently, so that a
+*   reader need only expand the block holding the tags it wants. The index
+*   records the name of the first tag in each block, so that the block may be
+*   found by bisection when the tags are sorted. All numbers are unsigned
+*   32-bit little-endian words.
+*
+*	header		LZ_HEADER_SIZE bytes
+*	blocks		compressed blocks, in the order of the lines they hold
+*	index		one LZ_ENTRY_SIZE entry per block
+*	names		NUL-terminated name of the first tag in each block
+*
+*   A block whose compressed size is equal to its length is stored as it is.
+*   Any other block is a series of sequences, each of which is:
+*
+*	token		one byte, of which the high four bits are the number
+*			of literals and the low four bits the length of the
+*			match less LZ_MIN_MATCH
+*	[count]		if the number of literals is 15, bytes to be added to
+*			it, up to and including the first less than 255
+*	literals	bytes to be copied to the output
+*	offset		two bytes (least significant first): the distance
+*			back in the output from which the match is copied
+*	[length]	if the match length is 15, bytes to be added to it, as
+*			for the number of literals
+*
+*   The last sequence of a block ends after its literals.
+*/
+#ifndef _LZFMT_H
+#define _LZFMT_H
+
+/*
+*   MACROS
+*/
+#define LZ_MAGIC		"CTAGSLZB"
+#define LZ_MAGIC_LENGTH		8
+#define LZ_VERSION		1
+
+/*  Offsets of words within header.
+ */
+#define LZ_H_VERSION		8
+#define LZ_H_BLOCK_COUNT	12	/* number of blocks */
+#define LZ_H_BLOCK_LENGTH	16	/* greatest length of any block */
+#define LZ_H_INDEX		20	/* file offset of index */
+#define LZ_H_NAMES_SIZE		24	/* size of names in bytes */
+#define LZ_HEADER_SIZE		28
+
+/*  Offsets of words within each index entry.
+ */
+#define LZ_E_OFFSET		0	/* file offset of block */
+#define LZ_E_SIZE		4	/* compressed size of block */
+#define LZ_E_LENGTH		8	/* length of lines held in block */
+#define LZ_E_NAME		12	/* offset of first tag name in names */
+#define LZ_ENTRY_SIZE		16
+
+/*  Limits of matches.
+ */
+#define LZ_MIN_MATCH		4
+#define LZ_MAX_OFFSET		65535
+
+#endif	/* _LZFMT_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
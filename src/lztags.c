@@ -0,0 +1,339 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for compressing a tag file (the --compress
+*   option) into the block-compressed form described in lzfmt.h, which
+*   readtags.c reads in place of the original. The compressor is a simple
+*   greedy LZ77 scheme, fast to expand, which does well on the repetitive
+*   lines of a tag file.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "debug.h"
+#include "entry.h"
+#include "lzfmt.h"
+#include "lztags.h"
+#include "options.h"
+#include "routines.h"
+#include "vstring.h"
+
+/*
+*   MACROS
+*/
+#define BLOCK_LENGTH	65536	/* length of lines gathered into a block */
+#define HASH_BITS	14	/* size of table of recent positions */
+#define HASH_SIZE	(1 << HASH_BITS)
+#define NO_POSITION	((unsigned long) -1)
+#define MAX_WORD	0xffffffffUL
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  State of a tag file being compressed.
+ */
+typedef struct sCompressor {
+    FILE *fp;
+    unsigned long *recent;	/* position last seen for each hash */
+    unsigned char *output;	/* compressed block */
+    unsigned long *entries;	/* index, LZ_ENTRY_SIZE / 4 words per block */
+    unsigned long blockCount;
+    unsigned long blockSpace;
+    unsigned long blockLength;	/* greatest length of any block */
+    char *names;		/* first tag name of each block */
+    size_t namesLength;
+    size_t namesSpace;
+} compressor;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static unsigned long getFour (const unsigned char *const p)
+{
+    return (unsigned long) p [0]         | ((unsigned long) p [1] << 8) |
+	   ((unsigned long) p [2] << 16) | ((unsigned long) p [3] << 24);
+}
+
+static unsigned int hashPosition (const unsigned char *const p)
+{
+    return (unsigned int) (((getFour (p) * 2654435761UL) & MAX_WORD) >>
+			   (32 - HASH_BITS));
+}
+
+static unsigned char *putCount (unsigned char *out, size_t count)
+{
+    while (count >= 255)
+    {
+	*out++ = 255;
+	count -= 255;
+    }
+    *out++ = (unsigned char) count;
+    return out;
+}
+
+/*  Writes a sequence of literals followed by a match (unless the length of
+ *  the match is 0, for the last sequence of a block).
+ */
+static unsigned char *putSequence (unsigned char *out,
+				   const unsigned char *const literals,
+				   const size_t literalCount,
+				   const size_t offset,
+				   const size_t matchLength)
+{
+    unsigned char *const token = out++;
+    unsigned int value;
+
+    if (literalCount < 15)
+	value = (unsigned int) literalCount << 4;
+    else
+    {
+	value = 15 << 4;
+	out = putCount (out, literalCount - 15);
+    }
+    memcpy (out, literals, literalCount);
+    out += literalCount;
+    if (matchLength > 0)
+    {
+	const size_t extra = matchLength - LZ_MIN_MATCH;
+
+	*out++ = (unsigned char) (offset & 0xff);
+	*out++ = (unsigned char) ((offset >> 8) & 0xff);
+	if (extra < 15)
+	    value |= (unsigned int) extra;
+	else
+	{
+	    value |= 15;
+	    out = putCount (out, extra - 15);
+	}
+    }
+    *token = (unsigned char) value;
+    return out;
+}
+
+/*  Compresses a block into the output buffer, which must have room for
+ *  the worst case (see compressBound ()). Returns the compressed size.
+ */
+static size_t compressBlock (compressor *const state,
+			     const unsigned char *const in, const size_t length)
+{
+    unsigned char *out = state->output;
+    size_t anchor = 0;
+    size_t i = 0;
+    int h;
+
+    for (h = 0  ;  h < HASH_SIZE  ;  ++h)
+	state->recent [h] = NO_POSITION;
+    while (i + LZ_MIN_MATCH <= length)
+    {
+	const unsigned int hash = hashPosition (in + i);
+	const unsigned long candidate = state->recent [hash];
+
+	state->recent [hash] = i;
+	if (candidate != NO_POSITION  &&  i - candidate <= LZ_MAX_OFFSET  &&
+	    memcmp (in + candidate, in + i, (size_t) LZ_MIN_MATCH) == 0)
+	{
+	    size_t matchLength = LZ_MIN_MATCH;
+
+	    while (i + matchLength < length  &&
+		   in [candidate + matchLength] == in [i + matchLength])
+		++matchLength;
+	    out = putSequence (out, in + anchor, i - anchor,
+			       i - candidate, matchLength);
+	    i += matchLength;
+	    anchor = i;
+	}
+	else
+	    ++i;
+    }
+    out = putSequence (out, in + anchor, length - anchor, 0, 0);
+    return (size_t) (out - state->output);
+}
+
+static size_t compressBound (const size_t length)
+{
+    return length + length / 255 + 16;
+}
+
+static void putWord (FILE *const fp, const unsigned long word)
+{
+    putc ((int) (word & 0xff), fp);
+    putc ((int) ((word >> 8) & 0xff), fp);
+    putc ((int) ((word >> 16) & 0xff), fp);
+    putc ((int) ((word >> 24) & 0xff), fp);
+}
+
+/*  Adds the name of the first tag in a block to the names, returning its
+ *  offset within them.
+ */
+static unsigned long addName (compressor *const state,
+			      const unsigned char *const text,
+			      const size_t length)
+{
+    const size_t offset = state->namesLength;
+    size_t nameLength = 0;
+
+    while (nameLength < length  &&  text [nameLength] != '\t'  &&
+	   text [nameLength] != '\n')
+	++nameLength;
+    while (state->namesLength + nameLength + 1 > state->namesSpace)
+    {
+	state->namesSpace = (state->namesSpace == 0) ? 4096 : 2 * state->namesSpace;
+	state->names = xRealloc (state->names, state->namesSpace, char);
+    }
+    memcpy (state->names + offset, text, nameLength);
+    state->names [offset + nameLength] = '\0';
+    state->namesLength += nameLength + 1;
+    return (unsigned long) offset;
+}
+
+/*  Compresses and writes a block of whole lines, adding it to the index.
+ */
+static void writeBlock (compressor *const state,
+			const unsigned char *const text, const size_t length)
+{
+    const long offset = ftell (state->fp);
+    unsigned long *entry;
+    size_t size;
+
+    if (state->blockCount == state->blockSpace)
+    {
+	state->blockSpace = (state->blockSpace == 0) ? 256 : 2 * state->blockSpace;
+	state->entries = xRealloc (state->entries,
+				   state->blockSpace * (LZ_ENTRY_SIZE / 4),
+				   unsigned long);
+    }
+    if (offset < 0  ||  (unsigned long) offset > MAX_WORD - length)
+	error (FATAL, "tag file too large to compress");
+    entry = state->entries + state->blockCount * (LZ_ENTRY_SIZE / 4);
+    entry [0] = (unsigned long) offset;
+    entry [2] = (unsigned long) length;
+    entry [3] = addName (state, text, length);
+    ++state->blockCount;
+    if (length > state->blockLength)
+	state->blockLength = length;
+
+    size = compressBlock (state, text, length);
+    if (size < length)
+	fwrite (state->output, (size_t) 1, size, state->fp);
+    else
+    {
+	size = length;		/* stored as it is */
+	fwrite (text, (size_t) 1, length, state->fp);
+    }
+    entry [1] = (unsigned long) size;
+}
+
+/*  Reads the tag file, writing its lines in blocks of about BLOCK_LENGTH
+ *  bytes. The buffer is enlarged to hold any line longer than that.
+ */
+static void writeBlocks (compressor *const state, FILE *const in)
+{
+    size_t space = BLOCK_LENGTH;
+    unsigned char *text = xMalloc (space, unsigned char);
+    size_t length = 0;
+    boolean atEnd = FALSE;
+
+    state->output = xMalloc (compressBound (space), unsigned char);
+    while (! atEnd  ||  length > 0)
+    {
+	size_t cut;
+
+	if (! atEnd  &&  length < space)
+	{
+	    length += fread (text + length, (size_t) 1, space - length, in);
+	    atEnd = (boolean) (length < space);
+	    if (ferror (in))
+		error (FATAL | PERROR, "cannot read tag file");
+	}
+	for (cut = length  ;  cut > 0  &&  text [cut - 1] != '\n'  ;  --cut)
+	    ;
+	if (atEnd)
+	    cut = length;		/* last line may lack newline */
+	if (cut == 0  &&  length > 0)
+	{
+	    /*  Line longer than buffer */
+	    space *= 2;
+	    text = xRealloc (text, space, unsigned char);
+	    state->output = xRealloc (state->output, compressBound (space),
+				      unsigned char);
+	}
+	else if (cut > 0)
+	{
+	    writeBlock (state, text, cut);
+	    memmove (text, text + cut, length - cut);
+	    length -= cut;
+	}
+    }
+    eFree (text);
+}
+
+/*  Replaces a tag file with its compressed form. The compressed file is
+ *  written alongside the tag file, then renamed over it.
+ */
+extern void compressTagFile (const char *const name)
+{
+    vString *const newName = vStringNewInit (name);
+    compressor state;
+    FILE *in;
+    long index;
+    unsigned long i;
+
+    vStringCatS (newName, NEW_TAG_FILE_SUFFIX);
+    in = fopen (name, "rb");
+    if (in == NULL)
+	error (FATAL | PERROR, "cannot open tag file \"%s\"", name);
+    memset (&state, 0, sizeof (state));
+    state.fp = fopen (vStringValue (newName), "wb");
+    if (state.fp == NULL)
+	error (FATAL | PERROR, "cannot open tag file \"%s\"",
+	       vStringValue (newName));
+    state.recent = xMalloc (HASH_SIZE, unsigned long);
+
+    verbose ("compressing tag file\n");
+    fseek (state.fp, (long) LZ_HEADER_SIZE, SEEK_SET);
+    writeBlocks (&state, in);
+    fclose (in);
+
+    index = ftell (state.fp);
+    if (index < 0  ||  (unsigned long) index > MAX_WORD)
+	error (FATAL, "tag file too large to compress");
+    for (i = 0  ;  i < state.blockCount * (LZ_ENTRY_SIZE / 4)  ;  ++i)
+	putWord (state.fp, state.entries [i]);
+    fwrite (state.names, (size_t) 1, state.namesLength, state.fp);
+
+    rewind (state.fp);
+    fwrite (LZ_MAGIC, (size_t) 1, (size_t) LZ_MAGIC_LENGTH, state.fp);
+    putWord (state.fp, LZ_VERSION);
+    putWord (state.fp, state.blockCount);
+    putWord (state.fp, state.blockLength);
+    putWord (state.fp, (unsigned long) index);
+    putWord (state.fp, (unsigned long) state.namesLength);
+    if (ferror (state.fp)  ||  fclose (state.fp) != 0)
+	error (FATAL | PERROR, "cannot write tag file \"%s\"",
+	       vStringValue (newName));
+    if (rename (vStringValue (newName), name) != 0)
+	error (FATAL | PERROR, "cannot replace tag file \"%s\"", name);
+
+    eFree (state.recent);
+    eFree (state.output);
+    if (state.entries != NULL)
+	eFree (state.entries);
+    if (state.names != NULL)
+	eFree (state.names);
+    vStringDelete (newName);
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,26 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to lztags.c
+*/
+#ifndef _LZTAGS_H
+#define _LZTAGS_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void compressTagFile (const char *const name);
+
+#endif	/* _LZTAGS_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -77,11 +77,17 @@
 
 
 #include "debug.h"
+#include "dedup.h"
+#include "intern.h"
 #include "keyword.h"
 #include "main.h"
 #include "options.h"
+#include "profile.h"
 #include "read.h"
 #include "routines.h"
+#include "sort.h"
+#include "trace.h"
+#include "watch.h"
 
 /*
 *   MACROS
@@ -105,11 +111,6 @@ static struct { long files, lines, bytes; } Totals = { 0, 0, 0 };
   " "AUTHOR_NAME" $";
 #endif
 
-/*
-*   FUNCTION PROTOTYPES
-*/
-static boolean createTagsForEntry (const char *const entryName);
-
 /*
 *   FUNCTION DEFINITIONS
 */
@@ -351,7 +352,10 @@ static boolean recurseIntoDirectory (const char *const dirName)
 	verbose ("ignoring \"%s\" (directory)\n", dirName);
     else
     {
+	traceBegin ("ctags", "recurseIntoDirectory", dirName);
 	verbose ("RECURSING into directory \"%s\"\n", dirName);
+	if (Option.watch)
+	    watchDirectory (dirName);
 #if defined (HAVE_OPENDIR)
 	resize = recurseUsingOpendir (dirName);
 #elif defined (HAVE_FINDFIRST) || defined (HAVE__FINDFIRST)
@@ -377,11 +381,34 @@ static boolean recurseIntoDirectory (const char *const dirName)
 	    vStringDelete (pattern);
 	}
 #endif
+	traceEnd ("ctags", "recurseIntoDirectory");
     }
     return resize;
 }
 
-static boolean createTagsForEntry (const char *const entryName)
+/*  Determines whether a file belongs to the shard selected by --shard. The
+ *  file name is hashed (32-bit FNV-1a), so that every process given the same
+ *  arguments agrees on the shard to which each file belongs.
+ */
+static boolean isFileInShard (const char *const fileName)
+{
+    boolean result = TRUE;
+    if (Option.shards > 1)
+    {
+	unsigned long hash = 2166136261UL;
+	const unsigned char *p;
+
+	for (p = (const unsigned char *) fileName  ;  *p != '\0'  ;  ++p)
+	{
+	    hash ^= *p;
+	    hash = (hash * 16777619UL) & 0xffffffffUL;
+	}
+	result = (boolean) (hash % Option.shards == Option.shard - 1);
+    }
+    return result;
+}
+
+extern boolean createTagsForEntry (const char *const entryName)
 {
     boolean resize = FALSE;
     fileStatus *status = eStat (entryName);
@@ -397,6 +424,8 @@ static boolean createTagsForEntry (const char *const entryName)
 	resize = recurseIntoDirectory (entryName);
     else if (! status->isNormalFile)
 	verbose ("ignoring \"%s\" (special file)\n", entryName);
+    else if (! isFileInShard (entryName))
+	verbose ("ignoring \"%s\" (other shard)\n", entryName);
     else
 	resize = parseFile (entryName);
 
@@ -445,6 +474,8 @@ static boolean createTagsForArgs (cookedArgs* const args)
 	resize |= createTagsForEntry (arg);
 #endif
 	cArgForth (args);
+	if (! cArgOff (args)  &&  cArgIsOption (args))
+	    dedupForget ();	/* options may change the tags generated */
 	parseOptions (args);
     }
     return resize;
@@ -469,6 +500,8 @@ static boolean createTagsFromFileInput (FILE* const fp, const boolean filter)
 		fflush (stdout);
 	    }
 	    cArgForth (args);
+	    if (! cArgOff (args)  &&  cArgIsOption (args))
+		dedupForget ();	/* options may change the tags generated */
 	    parseOptions (args);
 	}
 	cArgDelete (args);
@@ -558,6 +591,32 @@ static void printTotals (const clock_t *const timeStamps)
 #endif
 }
 
+/*  Merges the tag files named on the command line and in any list file.
+ */
+static void mergeTags (cookedArgs* args)
+{
+    stringList *const files = stringListNew ();
+
+    while (! cArgOff (args))
+    {
+	stringListAdd (files, vStringNewInit (cArgItem (args)));
+	cArgForth (args);
+	parseOptions (args);
+    }
+    if (Option.fileList != NULL)
+    {
+	stringList *const listed = stringListNewFromFile (Option.fileList);
+	if (listed == NULL)
+	    error (FATAL | PERROR, "cannot open \"%s\"", Option.fileList);
+	stringListCombine (files, listed);
+    }
+    if (stringListCount (files) == 0)
+	error (FATAL, "No tag files specified. Try \"%s --help\".",
+	       getExecutableName ());
+    mergeTagFiles (files);
+    stringListDelete (files);
+}
+
 static void makeTags (cookedArgs* args)
 {
     clock_t timeStamps [3];
@@ -574,6 +633,7 @@ static void makeTags (cookedArgs* args)
 	openTagFile ();
 
     timeStamp (0);
+    profileBeginPhase (PHASE_WALK);
 
     if (! cArgOff (args))
     {
@@ -593,15 +653,26 @@ static void makeTags (cookedArgs* args)
     if (! files  &&  Option.recurse)
 	resize = recurseIntoDirectory (".");
 
+    profileEndPhase ();
     timeStamp (1);
 
     if (! Option.filter)
-	closeTagFile (resize);
+    {
+	profileBeginPhase (PHASE_SORT);
+	if (Option.watch)
+	    writeWatchedTags ();
+	else
+	    closeTagFile (resize);
+	profileEndPhase ();
+    }
 
     timeStamp (2);
 
     if (Option.printTotals)
 	printTotals (timeStamps);
+    if (Option.extendedTotals)
+	printProfile ();
+    writeProfile ();
 #undef timeStamp
 }
 
@@ -646,7 +717,13 @@ int main (int __unused__ argc, char **argv)
     verbose ("Reading initial options from command line\n");
     parseOptions (args);
     checkOptions ();
-    makeTags (args);
+    if (Option.merge)
+	mergeTags (args);
+    else
+	makeTags (args);
+    writeTrace ();
+    if (Option.watch)
+	watchForChanges ();
 
     /*  Clean up.
      */
@@ -654,11 +731,16 @@ int main (int __unused__ argc, char **argv)
     freeList (&Excluded);
     cArgDelete (args);
     freeKeywordTable ();
+    freeDedupResources ();
+    freeWatchResources ();
+    freeProfileResources ();
+    freeTraceResources ();
     freeSourceFileResources ();
     freeTagFileResources ();
     freeOptionResources ();
     freeParserResources ();
     freeRegexResources ();
+    freeInternResources ();
 
     exit (0);
     return 0;
@@ -26,6 +26,7 @@
 extern vString *combinePathAndFile (const char *const path, const char *const file);
 extern void addTotals (const unsigned int files, const long unsigned int lines, const long unsigned int bytes);
 extern boolean isDestinationStdout (void);
+extern boolean createTagsForEntry (const char *const entryName);
 extern void processExcludeOption (const char *const option, const char *const parameter);
 extern int main (int argc, char **argv);
 
@@ -15,7 +15,7 @@ DOS_VER_FILES=	ctags.h ctags.1 ctags.lsm NEWS
 
 VERSION_FILES=	$(DOS_VER_FILES) configure.in ctags.spec
 
-LIB_FILES	=	readtags.c readtags.h
+LIB_FILES	=	readtags.c readtags.h binfmt.h lzfmt.h
 
 ENVIRONMENT_MAKEFILES = \
 				mk_bc3.mak mk_bc5.mak mk_djg.mak mk_manx.mak mk_ming.mak \
@@ -28,7 +28,10 @@ COMMON_FILES =	COPYING EXTENDING.html FAQ INSTALL.oth NEWS README \
 
 UNIX_FILES	=	$(COMMON_FILES) \
 				.indent.pro INSTALL acconfig.h configure.in \
-				Makefile.in maintainer.mak testing.mak \
+				Makefile.in maintainer.mak testing.mak bench.mak \
+				bench/bench.sh bench/gencorpus.sh bench/benchutil.c \
+				bench/benchutil.h bench/findbench.c bench/kwbench.c \
+				bench/rebench.c bench/sortbench.c bench/vstrbench.c \
 				descrip.mms mkinstalldirs magic.diff \
 				ctags.1 ctags.lsm
 
@@ -105,10 +108,10 @@ ctags.cov: $(SOURCES) $(HEADERS) Makefile
 
 gcov: $(SOURCES:.c=.c.gcov)
 
-readtags: readtags.[ch]
+readtags: readtags.[ch] binfmt.h lzfmt.h
 	$(CC) -g $(COMP_FLAGS) -DDEBUG -DREADTAGS_MAIN -o $@ readtags.c
 
-readtags.o: readtags.c readtags.h
+readtags.o: readtags.c readtags.h binfmt.h lzfmt.h
 	$(CC) $(COMP_FLAGS) -c readtags.c
 
 etyperef: etyperef.o keyword.o routines.o strlist.o vstring.o
@@ -152,7 +155,7 @@ profclean:
 gcovclean:
 	rm -f $(COV_GEN)
 
-clean: depclean profclean gcovclean clean-test
+clean: depclean profclean gcovclean clean-test clean-bench
 	rm -f *.[ois] *.o[dm] ctags dctags mctags ctags*.exe readtags etyperef \
 		ctags.html ctags.prof ctags.cov *.bb *.bbg tags TAGS syntax.vim \
 		$(ERRFILE)
@@ -188,6 +191,11 @@ syntax.vim: $(DSOURCES) $(HEADERS) $(LIB_FILES)
 #
 include testing.mak
 
+#
+# Benchmarking
+#
+include bench.mak
+
 #
 # CVS management
 #
@@ -57,6 +57,10 @@
 # define RECURSE_SUPPORTED
 #endif
 
+#if defined (HAVE_SYS_INOTIFY_H)
+# define WATCH_SUPPORTED
+#endif
+
 #define isCompoundOption(c)	(boolean) (strchr ("fohiILpDb", (c)) != NULL)
 
 /*
@@ -145,7 +149,17 @@ optionValues Option = {
     NULL,		/* --filter-terminator */
     FALSE,		/* --tag-relative */
     FALSE,		/* --totals */
+    FALSE,		/* --totals=extended */
+    NULL,		/* --profile */
+    NULL,		/* --trace */
     FALSE,		/* --line-directives */
+    FALSE,		/* --dedup */
+    0, 0,		/* --shard */
+    FALSE,		/* --merge */
+    FALSE,		/* --watch */
+    OF_CTAGS,		/* --output-format */
+    FALSE,		/* --compress */
+    FALSE,		/* --cobol-regex */
 #ifdef DEBUG
     0, 0		/* -D, -b */
 #endif
@@ -193,6 +207,12 @@ static optionDescription LongOptionDescription [] = {
  {1,"  -x   Print a tabular cross reference file to standard output."},
  {1,"  --append=[yes|no]"},
  {1,"       Should tags should be appended to existing tag file [no]?"},
+ {1,"  --cobol-regex=[yes|no]"},
+ {1,"       Tag COBOL files with the former regular expressions [no]."},
+ {1,"  --compress=[yes|no]"},
+ {1,"       Write the tag file in independently compressed blocks for readtags [no]."},
+ {1,"  --dedup=[yes|no]"},
+ {1,"       Parse files with identical contents only once, reusing their tags [no]."},
  {1,"  --etags-include=file"},
  {1,"      Include reference to 'file' in Emacs-style tag file (requires -e)."},
  {1,"  --exclude=pattern"},
@@ -248,8 +268,15 @@ static optionDescription LongOptionDescription [] = {
  {1,"       Output a list of all tag kinds for specified language or all."},
  {1,"  --list-languages"},
  {1,"       Output list of supported languages."},
+ {1,"  --merge=[yes|no]"},
+ {1,"       Merge the sorted tag files supplied, instead of parsing sources [no]."},
  {1,"  --options=file"},
  {1,"       Specify file from which command line options should be read."},
+ {1,"  --output-format=ctags|bin|json"},
+ {1,"       Write a text tag file, a binary tag database for readtags, or one"},
+ {1,"       JSON object per line for each tag (unsorted, to stdout) [ctags]."},
+ {1,"  --profile=file"},
+ {1,"       Write a JSON summary of time spent by phase, language and file."},
  {1,"  --recurse=[yes|no]"},
 #ifdef RECURSE_SUPPORTED
  {1,"       Recurse into directories supplied on command line [no]."},
@@ -260,16 +287,27 @@ static optionDescription LongOptionDescription [] = {
  {1,"  --regex-<LANG>=/line_pattern/name_pattern/[flags]"},
  {1,"       Define regular expression for locating tags in specific language."},
 #endif
+ {1,"  --shard=i/N"},
+ {1,"       Only parse the i'th of N deterministic shards of the input files."},
  {0,"  --sort=[yes|no|foldcase]"},
  {0,"       Should tags be sorted (optionally ignoring case) [yes]?."},
  {0,"  --tag-relative=[yes|no]"},
  {0,"       Should paths be relative to location of tag file [no; yes when -e]?"},
- {1,"  --totals=[yes|no]"},
- {1,"       Print statistics about source and tag files [no]."},
+ {1,"  --totals=[yes|no|extended]"},
+ {1,"       Print statistics about source and tag files [no]. If extended,"},
+ {1,"       also print times by phase, statistics by language and slowest files."},
+ {1,"  --trace=file"},
+ {1,"       Write trace events for parsing, tag writing and sorting to file."},
  {1,"  --verbose=[yes|no]"},
  {1,"       Enable verbose messages describing actions on each source file."},
  {1,"  --version"},
  {1,"       Print version identifier to standard output."},
+ {1,"  --watch=[yes|no]"},
+#ifdef WATCH_SUPPORTED
+ {1,"       After generating tags, keep the tag file current as files change [no]."},
+#else
+ {1,"       Not supported on this platform."},
+#endif
  {1, NULL}
 };
 
@@ -385,6 +423,8 @@ extern void setDefaultTagFileName (void)
 	;		/* accept given name */
     else if (Option.etags)
 	Option.tagFileName = stringCopy (ETAGS_FILE);
+    else if (Option.outputFormat == OF_JSON)
+	Option.tagFileName = stringCopy ("-");
     else
 	Option.tagFileName = stringCopy (CTAGS_FILE);
 }
@@ -415,6 +455,89 @@ extern void checkOptions (void)
 	if (isDestinationStdout ())
 	    error (FATAL, "%s tags to stdout", notice);
     }
+    if (Option.merge)
+    {
+	notice = "merge mode is not compatible with";
+	if (Option.etags)
+	    error (FATAL, "%s etags output", notice);
+	if (Option.append)
+	    error (FATAL, "%s append mode", notice);
+	if (Option.filter)
+	    error (FATAL, "%s filter mode", notice);
+	if (Option.sorted == SO_UNSORTED)
+	    error (FATAL, "%s unsorted tags", notice);
+	if (Option.printTotals)
+	{
+	    error (WARNING, "merge mode disables totals");
+	    Option.printTotals = FALSE;
+	    Option.extendedTotals = FALSE;
+	}
+    }
+    if (Option.watch)
+    {
+	notice = "watch mode is not compatible with";
+	if (Option.etags)
+	    error (FATAL, "%s etags output", notice);
+	if (isDestinationStdout ())
+	    error (FATAL, "%s tags to stdout", notice);
+	if (Option.append)
+	    error (FATAL, "%s append mode", notice);
+	if (Option.merge)
+	    error (FATAL, "%s merge mode", notice);
+    }
+    if (Option.outputFormat == OF_BINARY)
+    {
+	notice = "binary output is not compatible with";
+	if (Option.etags)
+	    error (FATAL, "%s etags output", notice);
+	if (Option.xref)
+	    error (FATAL, "%s xref output", notice);
+	if (isDestinationStdout ())
+	    error (FATAL, "%s tags to stdout", notice);
+	if (Option.append)
+	    error (FATAL, "%s append mode", notice);
+	if (Option.filter)
+	    error (FATAL, "%s filter mode", notice);
+	if (Option.merge)
+	    error (FATAL, "%s merge mode", notice);
+	if (Option.watch)
+	    error (FATAL, "%s watch mode", notice);
+    }
+    if (Option.outputFormat == OF_JSON)
+    {
+	notice = "JSON output is not compatible with";
+	if (Option.etags)
+	    error (FATAL, "%s etags output", notice);
+	if (Option.xref)
+	    error (FATAL, "%s xref output", notice);
+	if (Option.append)
+	    error (FATAL, "%s append mode", notice);
+	if (Option.merge)
+	    error (FATAL, "%s merge mode", notice);
+	if (Option.watch)
+	    error (FATAL, "%s watch mode", notice);
+	Option.sorted = SO_UNSORTED;	/* tags are written as they are made */
+    }
+    if (Option.compress)
+    {
+	notice = "compressed output is not compatible with";
+	if (Option.outputFormat != OF_CTAGS)
+	    error (FATAL, "%s output formats other than ctags", notice);
+	if (Option.etags)
+	    error (FATAL, "%s etags output", notice);
+	if (Option.xref)
+	    error (FATAL, "%s xref output", notice);
+	if (isDestinationStdout ())
+	    error (FATAL, "%s tags to stdout", notice);
+	if (Option.append)
+	    error (FATAL, "%s append mode", notice);
+	if (Option.filter)
+	    error (FATAL, "%s filter mode", notice);
+	if (Option.merge)
+	    error (FATAL, "%s merge mode", notice);
+	if (Option.watch)
+	    error (FATAL, "%s watch mode", notice);
+    }
     if (Option.filter)
     {
 	notice = "filter mode";
@@ -422,6 +545,7 @@ extern void checkOptions (void)
 	{
 	    error (WARNING, "%s disables totals", notice);
 	    Option.printTotals = FALSE;
+	    Option.extendedTotals = FALSE;
 	}
 	if (Option.tagFileName != NULL)
 	    error (WARNING, "%s ignores output tag file name", notice);
@@ -1174,6 +1298,77 @@ static void processSortOption (
 	error (FATAL, "Invalid value for \"%s\" option", option);
 }
 
+static void processShardOption (
+	const char *const option, const char *const parameter)
+{
+    unsigned int shard, shards;
+    char dummy;
+
+    if (parameter [0] == '\0')
+	Option.shards = 0;
+    else if (sscanf (parameter, "%u/%u%c", &shard, &shards, &dummy) != 2)
+	error (FATAL, "Invalid value for \"%s\" option", option);
+    else if (shard < 1  ||  shard > shards)
+	error (FATAL, "Shard out of range for \"%s\" option", option);
+    else
+    {
+	Option.shard = shard;
+	Option.shards = shards;
+    }
+}
+
+static void processTotalsOption (
+	const char *const option, const char *const parameter)
+{
+    if (parameter [0] == '\0'  ||  isTrue (parameter))
+    {
+	Option.printTotals = TRUE;
+	Option.extendedTotals = FALSE;
+    }
+    else if (isFalse (parameter))
+    {
+	Option.printTotals = FALSE;
+	Option.extendedTotals = FALSE;
+    }
+    else if (strcasecmp (parameter, "extended") == 0)
+    {
+	Option.printTotals = TRUE;
+	Option.extendedTotals = TRUE;
+    }
+    else
+	error (FATAL, "Invalid value for \"%s\" option", option);
+}
+
+static void processOutputFormatOption (
+	const char *const option, const char *const parameter)
+{
+    if (strcmp (parameter, "ctags") == 0)
+	Option.outputFormat = OF_CTAGS;
+    else if (strcmp (parameter, "bin") == 0)
+	Option.outputFormat = OF_BINARY;
+    else if (strcmp (parameter, "json") == 0)
+	Option.outputFormat = OF_JSON;
+    else
+	error (FATAL, "Unknown output format \"%s\" in \"%s\" option",
+	       parameter, option);
+}
+
+static void processProfileOption (
+	const char *const __unused__ option, const char *const parameter)
+{
+    freeString (&Option.profileFile);
+    if (parameter [0] != '\0')
+	Option.profileFile = stringCopy (parameter);
+}
+
+static void processTraceOption (
+	const char *const __unused__ option, const char *const parameter)
+{
+    freeString (&Option.traceFile);
+    if (parameter [0] != '\0')
+	Option.traceFile = stringCopy (parameter);
+}
+
 static void installHeaderListDefaults (void)
 {
     Option.headerExt = stringListNewFromArgv (HeaderExtensions);
@@ -1348,12 +1543,20 @@ static parametricOption ParametricOptions [] = {
     { "list-maps",		processListMapsOption,		TRUE	},
     { "list-languages",		processListLanguagesOption,	TRUE	},
     { "options",		processOptionFile,		FALSE	},
+    { "output-format",		processOutputFormatOption,	TRUE	},
+    { "profile",		processProfileOption,		TRUE	},
+    { "shard",			processShardOption,		TRUE	},
     { "sort",			processSortOption,		TRUE	},
+    { "totals",			processTotalsOption,		TRUE	},
+    { "trace",			processTraceOption,		TRUE	},
     { "version",		processVersionOption,		TRUE	},
 };
 
 static booleanOption BooleanOptions [] = {
     { "append",		&Option.append,			TRUE	},
+    { "cobol-regex",	&Option.cobolRegex,		FALSE	},
+    { "compress",	&Option.compress,		TRUE	},
+    { "dedup",		&Option.dedup,			FALSE	},
     { "file-scope",	&Option.include.fileScope,	FALSE	},
     { "file-tags",	&Option.include.fileNames,	FALSE	},
     { "filter",		&Option.filter,			TRUE	},
@@ -1361,12 +1564,15 @@ static booleanOption BooleanOptions [] = {
     { "kind-long",	&Option.kindLong,		TRUE	},
     { "line-directives",&Option.lineDirectives,		FALSE	},
     { "links",		&Option.followLinks,		FALSE	},
+    { "merge",		&Option.merge,			TRUE	},
 #ifdef RECURSE_SUPPORTED
     { "recurse",	&Option.recurse,		FALSE	},
 #endif
     { "tag-relative",	&Option.tagRelative,		TRUE	},
-    { "totals",		&Option.printTotals,		TRUE	},
     { "verbose",	&Option.verbose,		FALSE	},
+#ifdef WATCH_SUPPORTED
+    { "watch",		&Option.watch,			TRUE	},
+#endif
 };
 
 /*
@@ -1458,6 +1664,10 @@ static void processLongOption (
 #ifndef RECURSE_SUPPORTED
     else if (strcmp (item, "recurse") == 0)
 	error (WARNING, "%s option not supported on this host", option);
+#endif
+#ifndef WATCH_SUPPORTED
+    else if (strcmp (option, "watch") == 0)
+	error (WARNING, "%s option not supported on this host", option);
 #endif
     else
 	error (FATAL, "Unknown option: --%s", option);
@@ -1734,6 +1944,8 @@ extern void freeOptionResources (void)
     freeString (&Option.tagFileName);
     freeString (&Option.fileList);
     freeString (&Option.filterTerminator);
+    freeString (&Option.profileFile);
+    freeString (&Option.traceFile);
 
     freeList (&Option.ignore);
     freeList (&Option.headerExt);
@@ -53,6 +53,12 @@ typedef enum eLocate {
     EX_PATTERN		/* -N  only patterns in tag file */
 } exCmd;
 
+typedef enum eOutputFormat {
+    OF_CTAGS,		/* text tag file (or etags/xref as selected) */
+    OF_BINARY,		/* binary tag database */
+    OF_JSON		/* one JSON object per tag */
+} outputFormat;
+
 typedef enum sortType {
     SO_UNSORTED,
     SO_SORTED,
@@ -106,7 +112,18 @@ typedef struct sOptionValues {
     char* filterTerminator; /* --filter-terminator  string to output */
     boolean tagRelative;    /* --tag-relative file paths relative to tag file */
     boolean printTotals;    /* --totals  print cumulative statistics */
+    boolean extendedTotals; /* --totals=extended  print profile by language */
+    char *profileFile;	    /* --profile  name of file for profile summary */
+    char *traceFile;	    /* --trace  name of file for trace events */
     boolean lineDirectives; /* --linedirectives  process #line directives */
+    boolean dedup;	    /* --dedup  parse identical files only once */
+    unsigned int shard;	    /* --shard  shard of input files to parse */
+    unsigned int shards;    /* --shard  number of shards (0 = no sharding) */
+    boolean merge;	    /* --merge  merge sorted tag files */
+    boolean watch;	    /* --watch  keep tag file current as files change */
+    outputFormat outputFormat;/* --output-format  format of tag file written */
+    boolean compress;	    /* --compress  write tag file in compressed blocks */
+    boolean cobolRegex;	    /* --cobol-regex  tag COBOL with regular expressions */
 #ifdef DEBUG
     long debugLevel;	    /* -D  debugging output */
     unsigned long breakLine;/* -b  source line at which to call lineBreak() */
@@ -20,15 +20,20 @@
 #include <fnmatch.h>
 #endif
 
+#include "bintags.h"
 #include "debug.h"
+#include "dedup.h"
 #include "entry.h"
 #include "main.h"
 #define OPTION_WRITE
 #include "options.h"
 #include "parsers.h" 
+#include "profile.h"
+#include "trace.h"
 #include "read.h"
 #include "routines.h"
 #include "vstring.h"
+#include "watch.h"
 
 /*
 *   DATA DEFINITIONS
@@ -281,12 +286,25 @@ extern void enableLanguage (const langType language, const boolean state)
     LanguageTable [language]->enabled = state;
 }
 
-static void initializeParsers (void)
+/*  Calls the initialization routine of a parser, unless already called.
+ *  This is deferred until the tables it builds (keywords, regex patterns)
+ *  are first needed, usually for the first file of the language, so that
+ *  a run over files of a few languages does not pay for all the others.
+ */
+extern void initializeParser (const langType language)
 {
-    unsigned int i;
-    for (i = 0  ;  i < LanguageCount  ;  ++i)
-	if (LanguageTable [i]->initialize != NULL)
-	    (LanguageTable [i]->initialize) ((langType) i);
+    parserDefinition* lang;
+    Assert (0 <= language  &&  language < (int) LanguageCount);
+    lang = LanguageTable [language];
+    if (! lang->initialized)
+    {
+	lang->initialized = TRUE;
+	if (lang->initialize != NULL)
+	{
+	    verbose ("Initializing %s parser\n", lang->name);
+	    (lang->initialize) (language);
+	}
+    }
 }
 
 extern void initializeParsing (void)
@@ -329,7 +347,6 @@ extern void initializeParsing (void)
     }
     verbose ("\n");
     enableLanguages (TRUE);
-    initializeParsers ();
 }
 
 extern void freeParserResources (void)
@@ -431,6 +448,7 @@ static void processLangKindOption (
     int c;
 
     Assert (0 <= language  &&  language < (int) LanguageCount);
+    initializeParser (language);	/* to install any regex kinds */
     if (*p != '+'  &&  *p != '-')
 	disableLanguageKinds (language);
     while ((c = *p++) != '\0') switch (c)
@@ -484,6 +502,7 @@ static void printKinds (langType language, boolean indent)
     if (lang->kinds != NULL  ||  lang->regex)
     {
 	unsigned int i;
+	initializeParser (language);
 	for (i = 0  ;  i < lang->kindCount  ;  ++i)
 	    printLanguageKind (lang->kinds + i, indent);
 	printRegexKinds (language, indent);
@@ -583,10 +602,12 @@ static boolean createTagsForFile (
 
 	makeFileTag (fileName);
 
+	traceBegin ("parser", LanguageTable [language]->name, NULL);
 	if (LanguageTable [language]->parser != NULL)
 	    LanguageTable [language]->parser ();
 	else if (LanguageTable [language]->parser2 != NULL)
 	    retried = LanguageTable [language]->parser2 (passCount);
+	traceEnd ("parser", LanguageTable [language]->name);
 
 	if (Option.etags)
 	    endEtagsFile (getSourceFileTagPath ());
@@ -604,15 +625,25 @@ static boolean createTagsWithFallback (
     fpos_t tagFilePosition;
     unsigned int passCount = 0;
     boolean tagFileResized = FALSE;
+    const size_t bufferedLength = vStringLength (TagFile.output);
 
-    fgetpos (TagFile.fp, &tagFilePosition);
+    if (! isTagOutputBuffered ())
+	fgetpos (TagFile.fp, &tagFilePosition);
     while (createTagsForFile (fileName, language, ++passCount))
     {
 	/*  Restore prior state of tag file.
 	 */
-	fsetpos (TagFile.fp, &tagFilePosition);
+	if (Option.outputFormat == OF_BINARY)
+	    truncateBinaryTags (numTags);
+	else if (isTagOutputBuffered ())
+	    vStringTruncate (TagFile.output, bufferedLength);
+	else
+	    fsetpos (TagFile.fp, &tagFilePosition);
 	TagFile.numTags.added = numTags;
 	tagFileResized = TRUE;
+	if (Option.dedup)
+	    dedupRestartFile ();
+	profileRetry ();
     }
     return tagFileResized;
 }
@@ -621,8 +652,13 @@ extern boolean parseFile (const char *const fileName)
 {
     boolean tagFileResized = FALSE;
     langType language = Option.language;
+    traceBegin ("ctags", "parseFile", fileName);
     if (Option.language == LANG_AUTO)
+    {
+	profileBeginPhase (PHASE_DETECT);
 	language = getFileLanguage (fileName);
+	profileEndPhase ();
+    }
     Assert (language != LANG_AUTO);
     if (language == LANG_IGNORE)
 	verbose ("ignoring %s (unknown language)\n", fileName);
@@ -633,14 +669,33 @@ extern boolean parseFile (const char *const fileName)
 	if (Option.filter)
 	    openTagFile ();
 
-	tagFileResized = createTagsWithFallback (fileName, language);
+	profileBeginPhase (PHASE_PARSE);
+	profileBeginFile (fileName, language);
+	if (Option.dedup  &&  dedupParseFile (fileName, language))
+	    ;		/* tags reused from an identical file */
+	else
+	{
+	    initializeParser (language);
+	    tagFileResized = createTagsWithFallback (fileName, language);
+	    if (Option.dedup)
+		dedupEndFile ();
+	}
+	profileEndFile ();
+	profileEndPhase ();
 
 	if (Option.filter)
+	{
+	    profileBeginPhase (PHASE_SORT);
 	    closeTagFile (tagFileResized);
+	    profileEndPhase ();
+	}
+	else if (Option.watch)
+	    watchCaptureTags (fileName);
+	else if (Option.outputFormat == OF_JSON)
+	    flushTagOutput ();
 	addTotals (1, 0L, 0L);
-
-	return tagFileResized;
     }
+    traceEnd ("ctags", "parseFile");
     return tagFileResized;
 }
 
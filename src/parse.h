@@ -58,6 +58,7 @@ typedef struct {
     /* used internally */
     unsigned int id;			/* id assigned to language */
     boolean enabled;			/* currently enabled? */
+    boolean initialized;		/* has initialize been called? */
     stringList* currentPatterns;	/* current list of file name patterns */
     stringList* currentExtensions;	/* current list of extensions */
 } parserDefinition;
@@ -100,6 +101,7 @@ extern void printLanguageMaps (const langType language);
 extern void enableLanguages (const boolean state);
 extern void enableLanguage (const langType language, const boolean state);
 extern void initializeParsing (void);
+extern void initializeParser (const langType language);
 extern void freeParserResources (void);
 extern void processLanguageDefineOption (const char *const option, const char *const parameter);
 extern boolean processKindOption (const char *const option, const char *const parameter);
@@ -112,6 +114,7 @@ extern boolean parseFile (const char *const fileName);
 #ifdef HAVE_REGEX
 extern void findRegexTags (void);
 extern boolean matchRegex (const vString* const line, const langType language);
+extern void prefilterRegex (const langType language);
 #endif
 extern boolean processRegexOption (const char *const option, const char *const parameter);
 extern void addLanguageRegex (const langType language, const char* const regex);
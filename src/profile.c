@@ -0,0 +1,372 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for recording where the time of a run is
+*   spent, by phase, by language and by file, and for reporting this for the
+*   --totals=extended and --profile options.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+#ifdef HAVE_TIME_H
+# include <time.h>
+#endif
+
+#include "debug.h"
+#include "entry.h"
+#include "options.h"
+#include "parse.h"
+#include "profile.h"
+#include "routines.h"
+
+/*
+*   MACROS
+*/
+#define MAX_PHASE_DEPTH	8	/* deepest nesting of phases */
+#define SLOWEST_COUNT	10	/* number of slowest files reported */
+
+/*
+*   DATA DECLARATIONS
+*/
+
+/*  Statistics for a single file or for all files of a language.
+ */
+typedef struct sProfileCounts {
+    unsigned long files;
+    unsigned long lines;
+    unsigned long bytes;
+    unsigned long tags;
+    unsigned long retries;
+    double seconds;
+} profileCounts;
+
+typedef struct sFileProfile {
+    char *name;
+    langType language;
+    profileCounts counts;
+} fileProfile;
+
+/*
+*   DATA DEFINITIONS
+*/
+static const char *const PhaseNames [PHASE_COUNT] = {
+    "walk", "detect", "parse", "write", "sort"
+};
+
+static double PhaseSeconds [PHASE_COUNT];
+static profilePhase PhaseStack [MAX_PHASE_DEPTH];
+static unsigned int PhaseDepth = 0;
+static double PhaseMark = 0.0;		/* time at last phase change */
+
+static profileCounts *Languages = NULL;	/* indexed by language */
+static unsigned int LanguageMax = 0;	/* allocated size of `Languages' */
+
+static fileProfile Current;		/* file being parsed */
+static boolean InFile = FALSE;
+static double FileStart = 0.0;
+static unsigned long FileTagsStart = 0;
+
+static fileProfile Slowest [SLOWEST_COUNT];
+static unsigned int SlowestCount = 0;
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Returns elapsed time in seconds from an arbitrary origin, using a
+ *  monotonic clock where one is available.
+ */
+extern double profileClock (void)
+{
+#if defined (CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+#elif defined (HAVE_CLOCK)
+    return (double) clock () / CLOCKS_PER_SEC;
+#else
+    return 0.0;
+#endif
+}
+
+static void chargePhase (const double time)
+{
+    if (PhaseDepth > 0)
+	PhaseSeconds [PhaseStack [PhaseDepth - 1]] += time - PhaseMark;
+    PhaseMark = time;
+}
+
+/*  Phases nest; the time spent in each is charged only to the innermost.
+ */
+extern void profileBeginPhase (const profilePhase phase)
+{
+    if (isProfiling ())
+    {
+	chargePhase (profileClock ());
+	Assert (PhaseDepth < MAX_PHASE_DEPTH);
+	if (PhaseDepth < MAX_PHASE_DEPTH)
+	    PhaseStack [PhaseDepth++] = phase;
+    }
+}
+
+extern void profileEndPhase (void)
+{
+    if (isProfiling ()  &&  PhaseDepth > 0)
+    {
+	chargePhase (profileClock ());
+	--PhaseDepth;
+    }
+}
+
+static profileCounts *languageCounts (const langType language)
+{
+    Assert (language >= 0);
+    if ((unsigned int) language >= LanguageMax)
+    {
+	const unsigned int max = (unsigned int) language + 16;
+	unsigned int i;
+
+	Languages = xRealloc (Languages, max, profileCounts);
+	for (i = LanguageMax  ;  i < max  ;  ++i)
+	    memset (&Languages [i], 0, sizeof (profileCounts));
+	LanguageMax = max;
+    }
+    return &Languages [language];
+}
+
+extern void profileBeginFile (const char *const fileName,
+			      const langType language)
+{
+    if (isProfiling ())
+    {
+	memset (&Current, 0, sizeof (Current));
+	Current.name = (char *) fileName;
+	Current.language = language;
+	Current.counts.files = 1;
+	InFile = TRUE;
+	FileTagsStart = TagFile.numTags.added;
+	FileStart = profileClock ();
+    }
+}
+
+/*  Called as each source file is closed. A file read more than once (because
+ *  its parser retried) is only counted once.
+ */
+extern void profileFileRead (const unsigned long lines,
+			     const unsigned long bytes)
+{
+    if (InFile)
+    {
+	Current.counts.lines = lines;
+	Current.counts.bytes = bytes;
+    }
+}
+
+extern void profileRetry (void)
+{
+    if (InFile)
+	++Current.counts.retries;
+}
+
+static void addCounts (profileCounts *const total,
+		       const profileCounts *const counts)
+{
+    total->files   += counts->files;
+    total->lines   += counts->lines;
+    total->bytes   += counts->bytes;
+    total->tags    += counts->tags;
+    total->retries += counts->retries;
+    total->seconds += counts->seconds;
+}
+
+static void rememberIfSlow (const fileProfile *const file)
+{
+    unsigned int i = SlowestCount;
+
+    if (SlowestCount < SLOWEST_COUNT)
+	++SlowestCount;
+    else if (file->counts.seconds <= Slowest [SLOWEST_COUNT - 1].counts.seconds)
+	return;
+    else
+	eFree (Slowest [--i].name);
+
+    while (i > 0  &&  Slowest [i - 1].counts.seconds < file->counts.seconds)
+    {
+	Slowest [i] = Slowest [i - 1];
+	--i;
+    }
+    Slowest [i] = *file;
+    Slowest [i].name = eStrdup (file->name);
+}
+
+extern void profileEndFile (void)
+{
+    if (InFile)
+    {
+	Current.counts.seconds = profileClock () - FileStart;
+	Current.counts.tags = TagFile.numTags.added - FileTagsStart;
+	addCounts (languageCounts (Current.language), &Current.counts);
+	rememberIfSlow (&Current);
+	InFile = FALSE;
+    }
+}
+
+static void sumLanguages (profileCounts *const total)
+{
+    unsigned int i;
+    memset (total, 0, sizeof (profileCounts));
+    for (i = 0  ;  i < LanguageMax  ;  ++i)
+	addCounts (total, &Languages [i]);
+}
+
+/*  Prints the extended totals: time per phase, statistics per language and
+ *  the slowest files.
+ */
+extern void printProfile (void)
+{
+    profileCounts total;
+    unsigned int i;
+
+    fprintf (errout, "time by phase:");
+    for (i = 0  ;  i < PHASE_COUNT  ;  ++i)
+	fprintf (errout, " %s %.03f s%s", PhaseNames [i], PhaseSeconds [i],
+		i + 1 < PHASE_COUNT ? "," : "\n");
+
+    fprintf (errout, "%-16s %7s %9s %9s %8s %7s %9s\n",
+	    "language", "files", "lines", "kB", "tags", "retries", "seconds");
+    for (i = 0  ;  i < LanguageMax  ;  ++i)
+    {
+	const profileCounts *const c = &Languages [i];
+	if (c->files > 0)
+	    fprintf (errout, "%-16s %7lu %9lu %9lu %8lu %7lu %9.03f\n",
+		    getLanguageName ((langType) i), c->files, c->lines,
+		    c->bytes / 1024L, c->tags, c->retries, c->seconds);
+    }
+    sumLanguages (&total);
+    fprintf (errout, "%-16s %7lu %9lu %9lu %8lu %7lu %9.03f\n", "total",
+	    total.files, total.lines, total.bytes / 1024L, total.tags,
+	    total.retries, total.seconds);
+
+    if (SlowestCount > 0)
+	fprintf (errout, "slowest files:\n");
+    for (i = 0  ;  i < SlowestCount  ;  ++i)
+    {
+	const fileProfile *const f = &Slowest [i];
+	fprintf (errout, "%9.03f s  %-12s %s (%lu lines, %lu kB, %lu tags)\n",
+		f->counts.seconds, getLanguageName (f->language), f->name,
+		f->counts.lines, f->counts.bytes / 1024L, f->counts.tags);
+    }
+}
+
+extern void writeJsonString (FILE *const fp, const char *const string)
+{
+    const unsigned char *p;
+
+    putc ('"', fp);
+    for (p = (const unsigned char *) string  ;  *p != '\0'  ;  ++p)
+    {
+	if (*p == '"'  ||  *p == '\\')
+	    fprintf (fp, "\\%c", *p);
+	else if (*p < 0x20)
+	    fprintf (fp, "\\u%04x", *p);
+	else
+	    putc (*p, fp);
+    }
+    putc ('"', fp);
+}
+
+static void writeJsonCounts (FILE *const fp, const profileCounts *const c)
+{
+    fprintf (fp, "\"files\": %lu, \"lines\": %lu, \"bytes\": %lu, "
+	    "\"tags\": %lu, \"retries\": %lu, \"seconds\": %.06f",
+	    c->files, c->lines, c->bytes, c->tags, c->retries, c->seconds);
+}
+
+/*  Writes a summary of the profile as a JSON object to the file named by
+ *  the --profile option.
+ */
+extern void writeProfile (void)
+{
+    const char *const fileName = Option.profileFile;
+    FILE *fp;
+    profileCounts total;
+    const char *separator;
+    unsigned int i;
+
+    if (fileName == NULL)
+	return;
+    if (strcmp (fileName, "-") == 0)
+	fp = stdout;
+    else
+	fp = fopen (fileName, "w");
+    if (fp == NULL)
+    {
+	error (WARNING | PERROR, "cannot open profile file \"%s\"", fileName);
+	return;
+    }
+
+    sumLanguages (&total);
+    fprintf (fp, "{\n  \"total\": { ");
+    writeJsonCounts (fp, &total);
+    fprintf (fp, " },\n  \"phases\": {");
+    for (i = 0  ;  i < PHASE_COUNT  ;  ++i)
+	fprintf (fp, "%s \"%s\": %.06f", i == 0 ? "" : ",",
+		PhaseNames [i], PhaseSeconds [i]);
+    fprintf (fp, " },\n  \"languages\": [");
+    separator = "\n";
+    for (i = 0  ;  i < LanguageMax  ;  ++i)
+    {
+	if (Languages [i].files > 0)
+	{
+	    fprintf (fp, "%s    { \"language\": ", separator);
+	    writeJsonString (fp, getLanguageName ((langType) i));
+	    fprintf (fp, ", ");
+	    writeJsonCounts (fp, &Languages [i]);
+	    fprintf (fp, " }");
+	    separator = ",\n";
+	}
+    }
+    fprintf (fp, "\n  ],\n  \"slowest\": [");
+    separator = "\n";
+    for (i = 0  ;  i < SlowestCount  ;  ++i)
+    {
+	fprintf (fp, "%s    { \"file\": ", separator);
+	writeJsonString (fp, Slowest [i].name);
+	fprintf (fp, ", \"language\": ");
+	writeJsonString (fp, getLanguageName (Slowest [i].language));
+	fprintf (fp, ", ");
+	writeJsonCounts (fp, &Slowest [i].counts);
+	fprintf (fp, " }");
+	separator = ",\n";
+    }
+    fprintf (fp, "\n  ]\n}\n");
+
+    if (fp == stdout)
+	fflush (fp);
+    else if (fclose (fp) != 0)
+	error (WARNING | PERROR, "cannot write profile file \"%s\"", fileName);
+}
+
+extern void freeProfileResources (void)
+{
+    unsigned int i;
+    for (i = 0  ;  i < SlowestCount  ;  ++i)
+	eFree (Slowest [i].name);
+    SlowestCount = 0;
+    if (Languages != NULL)
+	eFree (Languages);
+    Languages = NULL;
+    LanguageMax = 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
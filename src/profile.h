@@ -0,0 +1,59 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to profile.c
+*/
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <stdio.h>
+
+#include "options.h"
+#include "parse.h"
+
+/*
+*   MACROS
+*/
+#define isProfiling()	(boolean) (Option.extendedTotals || \
+				   Option.profileFile != NULL)
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef enum eProfilePhase {
+    PHASE_WALK,		/* finding and examining input files */
+    PHASE_DETECT,	/* determining the language of each file */
+    PHASE_PARSE,	/* running the parsers, other than writing tags */
+    PHASE_WRITE,	/* writing tag entries */
+    PHASE_SORT,		/* closing and sorting the tag file */
+    PHASE_COUNT
+} profilePhase;
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern double profileClock (void);
+extern void writeJsonString (FILE *const fp, const char *const string);
+extern void profileBeginPhase (const profilePhase phase);
+extern void profileEndPhase (void);
+extern void profileBeginFile (const char *const fileName, const langType language);
+extern void profileFileRead (const unsigned long lines, const unsigned long bytes);
+extern void profileRetry (void);
+extern void profileEndFile (void);
+extern void printProfile (void);
+extern void writeProfile (void);
+extern void freeProfileResources (void);
+
+#endif	/* _PROFILE_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
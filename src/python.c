@@ -8,12 +8,20 @@
 *
 *   This module contains functions for generating tags for Python language
 *   files.
+*
+*   Each line is scanned once, left to right, keeping track of string
+*   literals (of every form, since a prefix such as r, b or f does not change
+*   where a literal ends), brackets and line continuations, so that only the
+*   start of a logical line is examined for a class or function definition.
+*   The indentation of each definition is kept in a stack, which gives the
+*   scope of the definitions nested within it.
 */
 /*
 *   INCLUDE FILES
 */
 #include "general.h"	/* must always come first */
 
+#include <ctype.h>
 #include <string.h>
 
 #include "entry.h"
@@ -23,87 +31,186 @@
 #include "vstring.h"
 
 /*
-*   DATA DEFINITIONS
+*   MACROS
+*/
+#define TAB_WIDTH	8	/* columns between tab stops, for indentation */
+
+/*
+*   DATA DECLARATIONS
 */
 typedef enum {
     K_CLASS, K_FUNCTION, K_MEMBER
 } pythonKind;
 
+/*  A class or function whose body is being read.
+ */
+typedef struct sNestingLevel {
+    int indent;		/* indentation of its definition */
+    pythonKind kind;
+    vString *name;	/* name, qualified by those of enclosing levels */
+    size_t nameStart;	/* offset of unqualified name within name */
+} nestingLevel;
+
+/*  State of the scan carried from one line to the next.
+ */
+typedef struct sScanState {
+    int quote;		/* quote ending string being read, or '\0' */
+    boolean triple;	/* is string triple quoted? */
+    boolean continued;	/* did previous line end with a backslash? */
+    int depth;		/* depth of open brackets */
+} scanState;
+
+/*  A class whose list of base classes is being read.
+ */
+typedef struct sPendingClass {
+    boolean active;
+    unsigned int level;	/* nesting level of the class */
+    int depth;		/* bracket depth outside the list */
+    vString *inheritance;
+    unsigned long lineNumber;
+    fpos_t filePosition;
+} pendingClass;
+
+/*
+*   DATA DEFINITIONS
+*/
 static kindOption PythonKinds[] = {
     {TRUE, 'c', "class",    "classes"},
     {TRUE, 'f', "function", "functions"},
     {TRUE, 'm', "member",   "class members"}
 };
 
+static nestingLevel *Nesting = NULL;
+static unsigned int NestingDepth = 0;	/* number of levels in use */
+static unsigned int NestingSpace = 0;	/* number of levels allocated */
+
 /*
 *   FUNCTION DEFINITIONS
 */
-/* tagEntryInfo and vString should be preinitialized/preallocated but not
- * necessary. If successful you will find class name in vString
- */
 
 static boolean isIdentifierFirstCharacter (int c)
 {
-    return (boolean) (isalpha (c) || c == '_');
+    return (boolean) (isalpha (c) || c == '_' || c >= 0x80);
 }
 
 static boolean isIdentifierCharacter (int c)
 {
-    return (boolean) (isalnum (c) || c == '_');
+    return (boolean) (isalnum (c) || c == '_' || c >= 0x80);
 }
 
-static void makeFunctionTag (vString *const function, vString *const class)
+static boolean isQuote (int c)
 {
-    tagEntryInfo tag;
-    initTagEntry (&tag, vStringValue (function));
-    if (vStringLength (class) > 0)
-    {
-	tag.kindName = "member";
-	tag.kind = 'm';
-	tag.extensionFields.scope [0] = "class";
-	tag.extensionFields.scope [1] = vStringValue (class);
-    }
-    else
-    {
-	tag.kindName = "function";
-	tag.kind = 'f';
-    }
-    if (strncmp (vStringValue (function), "__", 2) == 0 &&
-	strcmp (vStringValue (function), "__init__") != 0)
+    return (boolean) (c == '"' || c == '\'');
+}
+
+/*
+*   Tag generation functions
+*/
+
+static void makePythonTag (const unsigned int level,
+			   const char *const inheritance,
+			   const unsigned long lineNumber,
+			   const fpos_t *const filePosition)
+{
+    const nestingLevel *const nl = &Nesting [level];
+    const char *const name = vStringValue (nl->name) + nl->nameStart;
+
+    if (PythonKinds [nl->kind].enabled)
     {
-	tag.extensionFields.access = "private";
-	tag.isFileScope = TRUE;
+	tagEntryInfo tag;
+	initTagEntry (&tag, name);
+	tag.lineNumber = lineNumber;
+	tag.filePosition = *filePosition;
+	tag.kindName = PythonKinds [nl->kind].name;
+	tag.kind = PythonKinds [nl->kind].letter;
+	if (level > 0)
+	{
+	    const nestingLevel *const parent = &Nesting [level - 1];
+	    tag.extensionFields.scope [0] = PythonKinds [parent->kind].name;
+	    tag.extensionFields.scope [1] = vStringValue (parent->name);
+	}
+	if (nl->kind == K_CLASS)
+	    tag.extensionFields.inheritance = inheritance;
+	else if (strncmp (name, "__", 2) == 0  &&  strcmp (name, "__init__") != 0)
+	{
+	    tag.extensionFields.access = "private";
+	    tag.isFileScope = TRUE;
+	}
+	else
+	    tag.extensionFields.access = "public";
+	makeTagEntry (&tag);
+	if (level > 0  &&  Option.include.qualifiedTags)
+	{
+	    tag.name = vStringValue (nl->name);
+	    makeTagEntry (&tag);
+	}
     }
-    else
+}
+
+/*
+*   Scope functions
+*/
+
+/*  Closes the classes and functions whose bodies end before a logical line
+ *  with the indentation `indent'.
+ */
+static void closeLevels (const int indent)
+{
+    while (NestingDepth > 0  &&  Nesting [NestingDepth - 1].indent >= indent)
+	--NestingDepth;
+}
+
+/*  Opens a class or function at the indentation `indent', returning its
+ *  level. A function defined in a class is a member of it.
+ */
+static unsigned int openLevel (const int indent, const pythonKind kind,
+			       const vString *const name)
+{
+    nestingLevel *nl;
+
+    if (NestingDepth == NestingSpace)
     {
-	tag.extensionFields.access = "public";
+	const unsigned int space = (NestingSpace == 0) ? 16 : 2 * NestingSpace;
+	Nesting = xRealloc (Nesting, space, nestingLevel);
+	while (NestingSpace < space)
+	    Nesting [NestingSpace++].name = vStringNew ();
     }
-    makeTagEntry (&tag);
-    if (vStringLength (class) > 0  &&  Option.include.qualifiedTags)
+    nl = &Nesting [NestingDepth];
+    nl->indent = indent;
+    nl->kind = kind;
+    vStringClear (nl->name);
+    if (NestingDepth > 0)
     {
-	vString *tagname = vStringNew ();
-	vStringCat (tagname, class);
-	vStringPut (tagname, '.');
-	vStringCat (tagname, function);
-	tag.name = vStringValue (tagname);
-	makeTagEntry (&tag);
-	vStringDelete (tagname);
+	const nestingLevel *const parent = &Nesting [NestingDepth - 1];
+	vStringCopy (nl->name, parent->name);
+	vStringPut (nl->name, '.');
+	if (kind == K_FUNCTION  &&  parent->kind == K_CLASS)
+	    nl->kind = K_MEMBER;
     }
+    nl->nameStart = vStringLength (nl->name);
+    vStringCat (nl->name, name);
+    return NestingDepth++;
 }
 
-static void makeClassTag (vString *const class, vString *const inheritance)
+static void deleteLevels (void)
 {
-    tagEntryInfo tag;
-    initTagEntry (&tag, vStringValue (class));
-    tag.kindName = "class";
-    tag.kind = 'c';
-    tag.extensionFields.inheritance = vStringValue (inheritance);
-    makeTagEntry (&tag);
+    unsigned int i;
+    for (i = 0  ;  i < NestingSpace  ;  ++i)
+	vStringDelete (Nesting [i].name);
+    if (Nesting != NULL)
+	eFree (Nesting);
+    Nesting = NULL;
+    NestingDepth = 0;
+    NestingSpace = 0;
 }
 
+/*
+*   Scanning functions
+*/
+
 static const unsigned char *skipSpace (const unsigned char *cp)
 {
-    while (isspace ((int) *cp))
+    while (*cp == ' '  ||  *cp == '\t'  ||  *cp == '\f')
 	++cp;
     return cp;
 }
@@ -121,92 +228,213 @@ static const unsigned char *parseIdentifier (
     return cp;
 }
 
-static void parseClass (const unsigned char *cp, vString *const class)
+/*  Examines the start of a logical line, at `cp', for a definition, making
+ *  a tag for any found. Returns the position from which to continue the
+ *  scan of the line.
+ */
+static const unsigned char *parseStatement (const unsigned char *cp,
+					    const int indent,
+					    vString *const identifier,
+					    pendingClass *const pending)
 {
-    vString *const inheritance = vStringNew ();
-    vStringClear (inheritance);
-    cp = parseIdentifier (cp, class);
-    cp = skipSpace (cp);
-    if (*cp == '(')
+    const unsigned char *const start = cp;
+
+    cp = parseIdentifier (cp, identifier);
+    if (strcmp (vStringValue (identifier), "async") == 0  &&
+	(*cp == ' '  ||  *cp == '\t'))
     {
-	++cp;
-	while (*cp != ')'  &&  *cp != '\0')
+	cp = parseIdentifier (skipSpace (cp), identifier);
+    }
+    if (*cp != ' '  &&  *cp != '\t')
+	cp = start;
+    else if (strcmp (vStringValue (identifier), "def") == 0)
+    {
+	cp = parseIdentifier (skipSpace (cp), identifier);
+	if (vStringLength (identifier) > 0)
 	{
-	    vStringPut (inheritance, *cp);
-	    ++cp;
+	    const unsigned int level = openLevel (indent, K_FUNCTION, identifier);
+	    makePythonTag (level, NULL, getSourceLineNumber (),
+			   &getInputFilePosition ());
 	}
-	vStringTerminate (inheritance);
     }
-    makeClassTag (class, inheritance);
-    vStringDelete (inheritance);
+    else if (strcmp (vStringValue (identifier), "class") == 0)
+    {
+	cp = parseIdentifier (skipSpace (cp), identifier);
+	if (vStringLength (identifier) > 0)
+	{
+	    const unsigned int level = openLevel (indent, K_CLASS, identifier);
+	    cp = skipSpace (cp);
+	    vStringClear (pending->inheritance);
+	    if (*cp == '(')
+	    {
+		/*  Tagged once the list of base classes has been read */
+		pending->active = TRUE;
+		pending->level = level;
+		pending->depth = 0;
+		pending->lineNumber = getSourceLineNumber ();
+		pending->filePosition = getInputFilePosition ();
+	    }
+	    else
+		makePythonTag (level, vStringValue (pending->inheritance),
+			       getSourceLineNumber (), &getInputFilePosition ());
+	}
+    }
+    else
+	cp = start;
+    return cp;
 }
 
-static void parseFunction (const unsigned char *cp, vString *const class)
+/*  Scans the rest of a line from `cp', following strings and brackets.
+ */
+static void scanLine (const unsigned char *cp, scanState *const state,
+		      pendingClass *const pending)
 {
-    vString *const identifier = vStringNew ();
-    cp = parseIdentifier (cp, identifier);
-    makeFunctionTag (identifier, class);
-    vStringDelete (identifier);
+    while (*cp != '\0')
+    {
+	const int c = *cp;
+
+	if (state->quote != '\0')
+	{
+	    if (pending->active)
+		vStringPut (pending->inheritance, c);
+	    if (c == '\\')
+	    {
+		if (cp [1] == '\0')
+		    break;		/* string continues on next line */
+		if (pending->active)
+		    vStringPut (pending->inheritance, cp [1]);
+		cp += 2;
+	    }
+	    else if (c != state->quote)
+	    {
+		const size_t length = strcspn ((const char *) cp + 1,
+			(state->quote == '"') ? "\\\"" : "\\'");
+		if (pending->active)
+		    vStringNCatS (pending->inheritance, (const char *) cp + 1,
+				  length);
+		cp += 1 + length;
+	    }
+	    else if (! state->triple)
+	    {
+		state->quote = '\0';
+		++cp;
+	    }
+	    else if (cp [1] == c  &&  cp [2] == c)
+	    {
+		if (pending->active)
+		    vStringNCatS (pending->inheritance, (const char *) cp + 1, 2);
+		state->quote = '\0';
+		cp += 3;
+	    }
+	    else
+		++cp;
+	}
+	else if (c == '#')
+	    break;			/* comment */
+	else if (isQuote (c))
+	{
+	    state->quote = c;
+	    state->triple = (boolean) (cp [1] == c  &&  cp [2] == c);
+	    if (pending->active)
+		vStringNCatS (pending->inheritance, (const char *) cp,
+			      state->triple ? 3 : 1);
+	    cp += state->triple ? 3 : 1;
+	}
+	else if (c == '\\'  &&  cp [1] == '\0')
+	{
+	    state->continued = TRUE;
+	    ++cp;
+	}
+	else if (c == '('  ||  c == '['  ||  c == '{')
+	{
+	    if (pending->active  &&  state->depth > pending->depth)
+		vStringPut (pending->inheritance, c);
+	    ++state->depth;
+	    ++cp;
+	}
+	else if (c == ')'  ||  c == ']'  ||  c == '}')
+	{
+	    if (state->depth > 0)
+		--state->depth;
+	    if (pending->active  &&  state->depth > pending->depth)
+		vStringPut (pending->inheritance, c);
+	    else if (pending->active)
+	    {
+		vStringTerminate (pending->inheritance);
+		makePythonTag (pending->level,
+			       vStringValue (pending->inheritance),
+			       pending->lineNumber, &pending->filePosition);
+		pending->active = FALSE;
+	    }
+	    ++cp;
+	}
+	else
+	{
+	    size_t length = strcspn ((const char *) cp + 1, "#'\"\\()[]{}");
+	    ++length;		/* include this character, perhaps a '\\' */
+	    if (pending->active)
+		vStringNCatS (pending->inheritance, (const char *) cp, length);
+	    cp += length;
+	}
+    }
+    /*  A string in single quotes may not span lines without a backslash */
+    if (state->quote != '\0'  &&  ! state->triple  &&
+	! (*cp == '\\'  &&  cp [1] == '\0'))
+    {
+	state->quote = '\0';
+    }
 }
 
 static void findPythonTags (void)
 {
-    vString *const class = vStringNew ();
     vString *const identifier = vStringNew ();
     const unsigned char *line;
-    int class_indent = 0;
-    boolean longStringLiteral = FALSE;
+    scanState state;
+    pendingClass pending;
 
+    memset (&state, 0, sizeof (state));
+    memset (&pending, 0, sizeof (pending));
+    pending.inheritance = vStringNew ();
     while ((line = fileReadLine ()) != NULL)
     {
 	const unsigned char *cp = line;
-	int indent;
-
-	cp = skipSpace (cp);
-	indent = cp - line;
 
-	if (*cp == '#' || *cp == '\0')	/* skip comment or blank line */
-	    continue;
-	
-	if (longStringLiteral)
+	if (state.quote != '\0'  ||  state.depth > 0  ||  state.continued)
 	{
-	    cp = (const unsigned char*) strstr ((const char*) cp, "\"\"\"");
-	    if (cp == NULL)
-		continue;
-	    else
-	    {
-		longStringLiteral = FALSE;
-		cp += 3;
-	    }
+	    state.continued = FALSE;
+	    if (pending.active)
+		cp = skipSpace (cp);
 	}
-	if (isIdentifierFirstCharacter ((int) *cp))
+	else
 	{
-	    if (indent <= class_indent)
-		vStringClear (class);
+	    int indent = 0;
 
-	    cp = parseIdentifier (cp, identifier);
-	    if (isspace ((int) *cp))
+	    for (  ;  *cp == ' '  ||  *cp == '\t'  ||  *cp == '\f'  ;  ++cp)
 	    {
-		cp = skipSpace (cp);
-		if (strcmp (vStringValue (identifier), "def") == 0)
-		    parseFunction (cp, class);
-		else if (strcmp (vStringValue (identifier), "class") == 0)
-		{
-		    parseClass (cp, class);
-		    class_indent = indent;
-		}
+		if (*cp == '\t')
+		    indent = (indent / TAB_WIDTH + 1) * TAB_WIDTH;
+		else if (*cp == ' ')
+		    ++indent;
+		else
+		    indent = 0;
 	    }
+	    if (*cp == '#'  ||  *cp == '\0')	/* comment or blank line */
+		continue;
+	    closeLevels (indent);
+	    if (isIdentifierFirstCharacter ((int) *cp))
+		cp = parseStatement (cp, indent, identifier, &pending);
 	}
-	if ((cp = (const unsigned char*) strstr ((const char*)cp, "\"\"\"")) != NULL)
-	{
-	    cp += 3;
-	    cp = (const unsigned char*) strstr ((const char*) cp, "\"\"\"");
-	    if (cp == NULL)
-		longStringLiteral = TRUE;
-	}
+	scanLine (cp, &state, &pending);
+    }
+    if (pending.active)
+    {
+	vStringTerminate (pending.inheritance);
+	makePythonTag (pending.level, vStringValue (pending.inheritance),
+		       pending.lineNumber, &pending.filePosition);
     }
+    vStringDelete (pending.inheritance);
     vStringDelete (identifier);
-    vStringDelete (class);
+    deleteLevels ();
 }
 
 extern parserDefinition *PythonParser (void)
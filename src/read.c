@@ -25,6 +25,8 @@
 #include "main.h"
 #include "routines.h"
 #include "options.h"
+#include "profile.h"
+#include "trace.h"
 
 /*
 *   DATA DEFINITIONS
@@ -88,6 +90,8 @@ static void setSourceFileParameters (vString *const fileName)
 
     File.source.isHeader = isIncludeFile (vStringValue (fileName));
     File.source.language = getFileLanguage (vStringValue (fileName));
+    if (File.source.language != LANG_IGNORE)
+	initializeParser (File.source.language);    /* for its regex patterns */
 }
 
 static boolean setSourceFileName (vString *const fileName)
@@ -246,6 +250,8 @@ extern boolean fileOpen (const char *const fileName, const langType language)
 #endif
     boolean opened = FALSE;
 
+    traceBegin ("io", "fileOpen", fileName);
+
     /*	If another file was already open, then close it.
      */
     if (File.fp != NULL)
@@ -275,11 +281,15 @@ extern boolean fileOpen (const char *const fileName, const langType language)
 
 	setSourceFileParameters (vStringNewInit (fileName));
 	File.source.lineNumber = 0L;
+#ifdef HAVE_REGEX
+	prefilterRegex (File.source.language);
+#endif
 
 	verbose ("OPENING %s as %s language %sfile\n", fileName,
 		getLanguageName (language),
 		File.source.isHeader ? "include " : "");
     }
+    traceEnd ("io", "fileOpen");
     return opened;
 }
 
@@ -287,16 +297,22 @@ extern void fileClose (void)
 {
     if (File.fp != NULL)
     {
+	traceBegin ("io", "fileClose", NULL);
 	/*  The line count of the file is 1 too big, since it is one-based
 	 *  and is incremented upon each newline.
 	 */
-	if (Option.printTotals)
+	if (Option.printTotals  ||  isProfiling ())
 	{
 	    fileStatus *status = eStat (vStringValue (File.name));
-	    addTotals (0, File.lineNumber - 1L, status->size);
+	    const unsigned long lines =
+		    File.lineNumber > 0 ? File.lineNumber - 1L : 0L;
+	    if (Option.printTotals)
+		addTotals (0, lines, status->size);
+	    profileFileRead (lines, status->size);
 	}
 	fclose (File.fp);
 	File.fp = NULL;
+	traceEnd ("io", "fileClose");
     }
 }
 
@@ -440,6 +456,91 @@ extern int fileGetc (void)
     return c;
 }
 
+/*  Skips the characters of the current line up to, but not including, the
+ *  first of any in "stops", as would discarding them one at a time with
+ *  fileGetc (). Skipping stops at the end of the line (after its newline,
+ *  unless that is one of the stops), so that line numbers are kept. The
+ *  search is left to strcspn (), which is much faster than fileGetc () over
+ *  long runs of uninteresting text. Returns the last character skipped, or
+ *  '\0' if none was.
+ */
+extern int fileSkipToCharacter (const char *const stops)
+{
+    int last = '\0';
+    if (File.ungetch == '\0'  &&  File.currentLine != NULL)
+    {
+	const size_t length = strcspn ((const char *) File.currentLine, stops);
+
+	DebugStatement ( debugPrintf (DEBUG_READ, "%.*s", (int) length,
+				      (const char *) File.currentLine); )
+	if (length > 0)
+	    last = File.currentLine [length - 1];
+	File.currentLine += length;
+    }
+    return last;
+}
+
+/*  Reads a run of characters belonging to any of classes "mask" of "table",
+ *  appending them to "string" (unless NULL), and returns the character
+ *  following the run, as would reading them one at a time with fileGetc ().
+ *  The run is taken from the current line in bulk and may continue onto
+ *  following lines if the class includes newline.
+ */
+extern int fileGetSpan (vString *const string, const unsigned char *const table,
+			const int mask)
+{
+    int c = fileGetc ();
+
+    while (c != EOF  &&  (table [c] & mask) != 0)
+    {
+	if (string != NULL)
+	    vStringPut (string, c);
+	if (File.currentLine != NULL)
+	{
+	    const unsigned char *p = File.currentLine;
+
+	    while (*p != '\0'  &&  (table [*p] & mask) != 0)
+		++p;
+	    DebugStatement ( debugPrintf (DEBUG_READ, "%.*s",
+			(int) (p - File.currentLine), File.currentLine); )
+	    if (string != NULL)
+		vStringNCatS (string, (const char *) File.currentLine,
+			      (size_t) (p - File.currentLine));
+	    File.currentLine = (unsigned char *) p;
+	}
+	c = fileGetc ();
+    }
+    if (string != NULL)
+	vStringTerminate (string);
+    return c;
+}
+
+/*  Reads characters up to the first of any in "stops", appending them to
+ *  "string", and returns that character (or EOF), which is consumed.
+ */
+extern int fileGetToCharacter (vString *const string, const char *const stops)
+{
+    int c = fileGetc ();
+
+    while (c != EOF  &&  strchr (stops, c) == NULL)
+    {
+	vStringPut (string, c);
+	if (File.currentLine != NULL)
+	{
+	    const size_t length = strcspn ((const char *) File.currentLine,
+					   stops);
+
+	    DebugStatement ( debugPrintf (DEBUG_READ, "%.*s", (int) length,
+					  (const char *) File.currentLine); )
+	    vStringNCatS (string, (const char *) File.currentLine, length);
+	    File.currentLine += length;
+	}
+	c = fileGetc ();
+    }
+    vStringTerminate (string);
+    return c;
+}
+
 /*  An alternative interface to fileGetc (). Do not mix use of fileReadLine()
  *  and fileGetc() for the same file. The returned string does not contain
  *  the terminating newline. A NULL return value means that all lines in the
@@ -458,6 +559,59 @@ extern const unsigned char *fileReadLine (void)
     return result;
 }
 
+/*  Copies up to `size' bytes from the start of the input file into `buffer',
+ *  without disturbing reading of the file by fileGetc () or fileReadLine (),
+ *  which must not yet have begun. Returns the number of bytes copied.
+ */
+extern size_t filePeek (char *const buffer, const size_t size)
+{
+    size_t length = 0;
+    if (File.fp != NULL)
+    {
+	fpos_t start;
+
+	fgetpos (File.fp, &start);
+	length = fread (buffer, (size_t) 1, size, File.fp);
+	fsetpos (File.fp, &start);
+    }
+    return length;
+}
+
+/*  Passes the input file to `scan' in chunks, each beginning with the last
+ *  `overlap' bytes of the one before, until `scan' returns FALSE or the end
+ *  of the file is reached. As for filePeek (), reading of the file must not
+ *  yet have begun, and is not disturbed.
+ */
+extern void fileScan (const size_t overlap, fileScanner scan, void *const data)
+{
+    enum { ChunkSize = 65536 };
+    if (File.fp != NULL)
+    {
+	char *const buffer = xMalloc (overlap + ChunkSize, char);
+	size_t kept = 0;
+	boolean more;
+	fpos_t start;
+
+	fgetpos (File.fp, &start);
+	do
+	{
+	    const size_t count = fread (buffer + kept, (size_t) 1,
+					(size_t) ChunkSize, File.fp);
+	    const size_t length = kept + count;
+
+	    more = (boolean) (scan (buffer, length, data)  &&
+			      count == (size_t) ChunkSize);
+	    if (more)
+	    {
+		kept = (length < overlap) ? length : overlap;
+		memmove (buffer, buffer + length - kept, kept);
+	    }
+	} while (more);
+	fsetpos (File.fp, &start);
+	eFree (buffer);
+    }
+}
+
 /*
  *   Source file line reading with automatic buffer sizing
  */
@@ -66,6 +66,11 @@ enum eCharacters {
     CHAR_SYMBOL	  = ('C' + 0x80)
 };
 
+/*  Receives a chunk of the input file from fileScan (), returning whether
+ *  the next chunk is wanted.
+ */
+typedef boolean (*fileScanner) (const char *const chunk, const size_t length, void *const data);
+
 /*  Maintains the state of the current source file.
  */
 typedef struct sInputFile {
@@ -108,7 +113,12 @@ extern boolean fileEOF (void);
 extern void fileClose (void);
 extern int fileGetc (void);
 extern void fileUngetc (int c);
+extern int fileSkipToCharacter (const char *const stops);
+extern int fileGetSpan (vString *const string, const unsigned char *const table, const int mask);
+extern int fileGetToCharacter (vString *const string, const char *const stops);
 extern const unsigned char *fileReadLine (void);
+extern size_t filePeek (char *const buffer, const size_t size);
+extern void fileScan (const size_t overlap, fileScanner scan, void *const data);
 extern char *readLine (vString *const vLine, FILE *const fp);
 extern char *readSourceLine (vString *const vLine, fpos_t location, long *const pSeekValue);
 
@@ -22,12 +22,18 @@
 #endif
 #include <stdio.h>
 #include "readtags.h"
+#include "binfmt.h"
+#include "lzfmt.h"
 
 /*
 *   MACROS
 */
 #define TAB '\t'
 
+#ifndef EINVAL
+# define EINVAL 0
+#endif
+
 
 /*
 *   DATA DECLARATIONS
@@ -75,6 +81,49 @@ struct sTagFile {
 		/* list of key value pairs */
 	    tagExtensionField *list;
     } fields;
+	/* binary tag database (see binfmt.h) */
+    struct {
+	    /* contents of file, or NULL if a text tag file */
+	unsigned char *data;
+	    /* sections of file */
+	const unsigned char *records;
+	const unsigned char *fields;
+	const unsigned char *index;
+	const char *pool;
+	    /* number of records, field pairs and index entries */
+	unsigned long count;
+	unsigned long fieldCount;
+	unsigned long indexCount;
+	    /* size of pool */
+	unsigned long poolSize;
+	    /* header flags */
+	unsigned long flags;
+	    /* position of next tag to be read (in index if sorted) */
+	unsigned long next;
+	    /* position in index at which to continue search */
+	unsigned long searchNext;
+	    /* is the search using the order of the index? */
+	short ordered;
+    } binary;
+	/* block-compressed tag file (see lzfmt.h) */
+    struct {
+	    /* compressed file, or NULL if not compressed */
+	FILE *fp;
+	    /* index of blocks, followed by first tag name of each */
+	unsigned char *index;
+	const char *names;
+	unsigned long blockCount;
+	unsigned long namesSize;
+	    /* compressed and expanded contents of current block */
+	unsigned char *input;
+	char *text;
+	    /* number of current block (blockCount if none) and its length */
+	unsigned long block;
+	unsigned long length;
+	    /* offsets within block of next line and of last line read */
+	unsigned long next;
+	unsigned long lineStart;
+    } compressed;
 	/* buffers to be freed at close */
     struct {
 	    /* name of program author */
@@ -152,6 +201,13 @@ static int growString (vstring *s)
     return result;
 }
 
+/* Read little-endian word of binary or compressed tag file */
+static unsigned long getWord (const unsigned char *const p)
+{
+    return (unsigned long) p [0]         | ((unsigned long) p [1] << 8) |
+	   ((unsigned long) p [2] << 16) | ((unsigned long) p [3] << 24);
+}
+
 /* Copy name of tag out of tag line */
 static void copyName (tagFile *const file)
 {
@@ -223,12 +279,169 @@ static int readTagLineRaw (tagFile *const file)
     return result;
 }
 
+static const unsigned char *getBlockEntry (const tagFile *const file,
+					   const unsigned long number)
+{
+    return file->compressed.index + number * LZ_ENTRY_SIZE;
+}
+
+/* Adds to `count' the bytes following a field of 15 in a token. */
+static int getCount (const unsigned char **const p,
+		     const unsigned char *const end, unsigned long *const count)
+{
+    int result = 1;
+    unsigned int byte = 255;
+    while (result  &&  byte == 255)
+    {
+	if (*p == end)
+	    result = 0;
+	else
+	{
+	    byte = *(*p)++;
+	    *count += byte;
+	}
+    }
+    return result;
+}
+
+/* Expands a compressed block of `size' bytes into `length' bytes, failing
+ * if the block is malformed.
+ */
+static int expandBlock (const unsigned char *in, const unsigned long size,
+			char *const out, const unsigned long length)
+{
+    const unsigned char *const end = in + size;
+    unsigned long done = 0;
+    int result = 1;
+    while (result  &&  in < end)
+    {
+	const unsigned int token = *in++;
+	unsigned long count = token >> 4;
+	if (count == 15)
+	    result = getCount (&in, end, &count);
+	if (result  &&  (count > (unsigned long) (end - in)  ||
+			 count > length - done))
+	    result = 0;
+	else if (result)
+	{
+	    memcpy (out + done, in, (size_t) count);
+	    in += count;
+	    done += count;
+	}
+	if (result  &&  in < end)
+	{
+	    unsigned long offset = 0;
+	    unsigned long matchLength = token & 15;
+	    if (end - in < 2)
+		result = 0;
+	    else
+	    {
+		offset = (unsigned long) in [0] | ((unsigned long) in [1] << 8);
+		in += 2;
+		if (matchLength == 15)
+		    result = getCount (&in, end, &matchLength);
+		matchLength += LZ_MIN_MATCH;
+	    }
+	    if (result  &&  (offset == 0  ||  offset > done  ||
+			     matchLength > length - done))
+		result = 0;
+	    else if (result)
+	    {
+		unsigned long i;
+		for (i = 0  ;  i < matchLength  ;  ++i)
+		    out [done + i] = out [done - offset + i];
+		done += matchLength;
+	    }
+	}
+    }
+    return (result  &&  done == length);
+}
+
+/* Makes a block of a compressed tag file current, reading and expanding
+ * it unless it is already, and positions at its first line.
+ */
+static int loadBlock (tagFile *const file, const unsigned long number)
+{
+    int result = 0;
+    if (number < file->compressed.blockCount)
+    {
+	if (number == file->compressed.block)
+	    result = 1;
+	else
+	{
+	    const unsigned char *const entry = getBlockEntry (file, number);
+	    const unsigned long size = getWord (entry + LZ_E_SIZE);
+	    const unsigned long length = getWord (entry + LZ_E_LENGTH);
+	    unsigned char *const input = (size == length) ?
+		    (unsigned char*) file->compressed.text : file->compressed.input;
+	    if (fseek (file->compressed.fp,
+		       (long) getWord (entry + LZ_E_OFFSET), SEEK_SET) == 0  &&
+		fread (input, (size_t) 1, (size_t) size, file->compressed.fp)
+		    == (size_t) size)
+	    {
+		result = (size == length  ||
+			  expandBlock (input, size, file->compressed.text, length));
+	    }
+	    file->compressed.block = result ? number : file->compressed.blockCount;
+	    file->compressed.length = result ? length : 0;
+	}
+	file->compressed.next = 0;
+	file->compressed.lineStart = 0;
+    }
+    return result;
+}
+
+/* Reads the next line of a compressed tag file, from the next block if the
+ * current one is finished.
+ */
+static int readBlockLine (tagFile *const file)
+{
+    int result = 0;
+    int more = 1;
+    while (! result  &&  more)
+    {
+	const unsigned long next = file->compressed.next;
+	if (next < file->compressed.length)
+	{
+	    const char *const start = file->compressed.text + next;
+	    const size_t remaining = (size_t) (file->compressed.length - next);
+	    const char *const newline = (const char*) memchr (start, '\n', remaining);
+	    size_t length = (newline == NULL) ? remaining : (size_t) (newline - start);
+	    file->compressed.lineStart = next;
+	    file->compressed.next = next + length + (newline == NULL ? 0 : 1);
+	    while (length > 0  &&  start [length - 1] == '\r')
+		--length;
+	    while (length >= file->line.size)
+		growString (&file->line);
+	    memcpy (file->line.buffer, start, length);
+	    file->line.buffer [length] = '\0';
+	    result = 1;
+	}
+	else
+	    more = loadBlock (file, file->compressed.block + 1);
+    }
+    if (result)
+	copyName (file);
+    else
+	file->compressed.lineStart = file->compressed.next;
+    return result;
+}
+
+/* Positions a compressed tag file to read again the last line read. */
+static void unreadBlockLine (tagFile *const file)
+{
+    file->compressed.next = file->compressed.lineStart;
+}
+
 static int readTagLine (tagFile *const file)
 {
     int result;
     do
     {
-	result = readTagLineRaw (file);
+	if (file->compressed.fp != NULL)
+	    result = readBlockLine (file);
+	else
+	    result = readTagLineRaw (file);
     } while (result && *file->name.buffer == '\0');
     return result;
 }
@@ -388,7 +601,8 @@ static void readPseudoTags (tagFile *const file, tagFileInfo *const info)
     }
     while (1)
     {
-	fgetpos (file->fp, &startOfLine);
+	if (file->fp != NULL)
+	    fgetpos (file->fp, &startOfLine);
 	if (! readTagLine (file))
 	    break;
 	if (strncmp (file->line.buffer, PseudoTagPrefix, prefixLength) != 0)
@@ -423,23 +637,343 @@ static void readPseudoTags (tagFile *const file, tagFileInfo *const info)
 	    }
 	}
     }
-    fsetpos (file->fp, &startOfLine);
+    if (file->fp != NULL)
+	fsetpos (file->fp, &startOfLine);
+    else
+	unreadBlockLine (file);
 }
 
 static void gotoFirstLogicalTag (tagFile *const file)
 {
     fpos_t startOfLine;
     const size_t prefixLength = strlen (PseudoTagPrefix);
-    rewind (file->fp);
+    if (file->fp != NULL)
+	rewind (file->fp);
+    else
+	loadBlock (file, 0);
     while (1)
     {
-	fgetpos (file->fp, &startOfLine);
+	if (file->fp != NULL)
+	    fgetpos (file->fp, &startOfLine);
 	if (! readTagLine (file))
 	    break;
 	if (strncmp (file->line.buffer, PseudoTagPrefix, prefixLength) != 0)
 	    break;
     }
-    fsetpos (file->fp, &startOfLine);
+    if (file->fp != NULL)
+	fsetpos (file->fp, &startOfLine);
+    else
+	unreadBlockLine (file);
+}
+
+/*
+*  BINARY TAG DATABASE
+*/
+
+static const char *poolString (const tagFile *const file,
+			       const unsigned long offset)
+{
+    const char *result = EmptyString;
+    if (offset < file->binary.poolSize)
+	result = file->binary.pool + offset;
+    return result;
+}
+
+/* Is the section of `count' items of `size' bytes at `offset' within the
+ * file of `length' bytes?
+ */
+static int withinFile (const unsigned long offset, const unsigned long count,
+		       const unsigned long size, const unsigned long length)
+{
+    return (offset <= length  &&  count <= (length - offset) / size);
+}
+
+static int readBinaryTagFile (tagFile *const file, const char *const filePath,
+			      tagFileInfo *const info)
+{
+    int result = 0;
+    FILE *const fp = fopen (filePath, "rb");
+    unsigned long length = 0;
+    if (fp != NULL)
+    {
+	fseek (fp, 0, SEEK_END);
+	length = (unsigned long) ftell (fp);
+	rewind (fp);
+	file->binary.data = (unsigned char*) malloc (length + 1);
+	if (file->binary.data == NULL)
+	    perror (NULL);
+	else if (fread (file->binary.data, (size_t) 1, (size_t) length, fp)
+		    == (size_t) length  &&  length >= BIN_HEADER_SIZE)
+	    result = 1;
+	fclose (fp);
+    }
+    if (result)
+    {
+	const unsigned char *const header = file->binary.data;
+	const unsigned long records = getWord (header + BIN_H_RECORDS);
+	const unsigned long fields  = getWord (header + BIN_H_FIELDS);
+	const unsigned long index   = getWord (header + BIN_H_INDEX);
+	const unsigned long pool    = getWord (header + BIN_H_POOL);
+
+	file->binary.count      = getWord (header + BIN_H_TAG_COUNT);
+	file->binary.fieldCount = getWord (header + BIN_H_FIELD_COUNT);
+	file->binary.indexCount = getWord (header + BIN_H_INDEX_COUNT);
+	file->binary.poolSize   = getWord (header + BIN_H_POOL_SIZE);
+	file->binary.flags      = getWord (header + BIN_H_FLAGS);
+	result = (getWord (header + BIN_H_VERSION) == BIN_VERSION  &&
+	    withinFile (records, file->binary.count, BIN_RECORD_SIZE, length) &&
+	    withinFile (fields, file->binary.fieldCount, BIN_FIELD_SIZE,
+			length)  &&
+	    withinFile (index, file->binary.indexCount, 4, length)  &&
+	    withinFile (pool, file->binary.poolSize, 1, length));
+	if (result)
+	{
+	    file->binary.records = file->binary.data + records;
+	    file->binary.fields  = file->binary.data + fields;
+	    file->binary.index   = file->binary.data + index;
+	    file->binary.pool    = (const char*) file->binary.data + pool;
+	    file->binary.data [length] = '\0';  /* terminate last string */
+	}
+    }
+    if (result)
+    {
+	const unsigned char *const header = file->binary.data;
+	file->format = 2;
+	if (! (file->binary.flags & BIN_SORTED))
+	    file->sortMethod = TAG_UNSORTED;
+	else if (file->binary.flags & BIN_FOLDCASE)
+	    file->sortMethod = TAG_FOLDSORTED;
+	else
+	    file->sortMethod = TAG_SORTED;
+	file->program.name = duplicate (poolString (file,
+		getWord (header + BIN_H_PROGRAM_NAME)));
+	file->program.author = duplicate (poolString (file,
+		getWord (header + BIN_H_PROGRAM_AUTHOR)));
+	file->program.url = duplicate (poolString (file,
+		getWord (header + BIN_H_PROGRAM_URL)));
+	file->program.version = duplicate (poolString (file,
+		getWord (header + BIN_H_PROGRAM_VERSION)));
+	if (info != NULL)
+	{
+	    info->file.format     = file->format;
+	    info->file.sort       = file->sortMethod;
+	    info->program.author  = file->program.author;
+	    info->program.name    = file->program.name;
+	    info->program.url     = file->program.url;
+	    info->program.version = file->program.version;
+	}
+    }
+    return result;
+}
+
+static int isBinaryTagFile (FILE *const fp)
+{
+    char magic [BIN_MAGIC_LENGTH];
+    const int result = (fread (magic, (size_t) 1, (size_t) BIN_MAGIC_LENGTH, fp)
+		== (size_t) BIN_MAGIC_LENGTH  &&
+	    memcmp (magic, BIN_MAGIC, (size_t) BIN_MAGIC_LENGTH) == 0);
+    rewind (fp);
+    return result;
+}
+
+static const unsigned char *getRecord (const tagFile *const file,
+				       const unsigned long number)
+{
+    return file->binary.records + number * BIN_RECORD_SIZE;
+}
+
+/* Returns the record number of an entry in the index, or of the next record
+ * in order if the tags are not sorted. The number is past the last record if
+ * the entry is invalid.
+ */
+static unsigned long getIndexedRecord (const tagFile *const file,
+				       const unsigned long position)
+{
+    unsigned long result = file->binary.count;
+    if (position < file->binary.indexCount)
+	result = getWord (file->binary.index + 4 * position);
+    return result;
+}
+
+static const char *getRecordName (const tagFile *const file,
+				  const unsigned long number)
+{
+    return poolString (file, getWord (getRecord (file, number) + BIN_R_NAME));
+}
+
+static void parseBinaryRecord (tagFile *const file, const unsigned long number,
+			       tagEntry *const entry)
+{
+    const unsigned char *const record = getRecord (file, number);
+    const unsigned long kind = getWord (record + BIN_R_KIND);
+    unsigned long field = getWord (record + BIN_R_FIELD);
+    unsigned long count = getWord (record + BIN_R_FIELD_COUNT);
+    int i;
+
+    entry->name = poolString (file, getWord (record + BIN_R_NAME));
+    entry->file = poolString (file, getWord (record + BIN_R_FILE));
+    entry->address.pattern = poolString (file, getWord (record + BIN_R_ADDRESS));
+    entry->address.lineNumber = getWord (record + BIN_R_LINE);
+    entry->kind = (kind == 0) ? NULL : poolString (file, kind);
+    entry->fileScope = (getWord (record + BIN_R_FLAGS) & BIN_FILE_SCOPE) != 0;
+    entry->fields.list = NULL;
+    entry->fields.count = 0;
+
+    if (field > file->binary.fieldCount)
+	field = file->binary.fieldCount;
+    if (count > file->binary.fieldCount - field)
+	count = file->binary.fieldCount - field;
+    for ( ;  count > 0  ;  --count, ++field)
+    {
+	const unsigned char *const pair =
+		file->binary.fields + field * BIN_FIELD_SIZE;
+	if (entry->fields.count == file->fields.max)
+	    growFields (file);
+	if (entry->fields.count < file->fields.max)
+	{
+	    file->fields.list [entry->fields.count].key =
+		    poolString (file, getWord (pair + BIN_F_KEY));
+	    file->fields.list [entry->fields.count].value =
+		    poolString (file, getWord (pair + BIN_F_VALUE));
+	    ++entry->fields.count;
+	}
+    }
+    if (entry->fields.count > 0)
+	entry->fields.list = file->fields.list;
+    for (i = entry->fields.count  ;  i < file->fields.max  ;  ++i)
+    {
+	file->fields.list [i].key = NULL;
+	file->fields.list [i].value = NULL;
+    }
+}
+
+static tagResult readNextBinary (tagFile *const file, tagEntry *const entry)
+{
+    tagResult result = TagFailure;
+    unsigned long number = file->binary.next;
+    if (file->binary.flags & BIN_SORTED)
+	number = getIndexedRecord (file, file->binary.next);
+    if (number < file->binary.count)
+    {
+	++file->binary.next;
+	if (entry != NULL)
+	    parseBinaryRecord (file, number, entry);
+	result = TagSuccess;
+    }
+    return result;
+}
+
+/*
+*  COMPRESSED TAG FILE
+*/
+
+static int isCompressedTagFile (FILE *const fp)
+{
+    char magic [LZ_MAGIC_LENGTH];
+    const int result = (fread (magic, (size_t) 1, (size_t) LZ_MAGIC_LENGTH, fp)
+		== (size_t) LZ_MAGIC_LENGTH  &&
+	    memcmp (magic, LZ_MAGIC, (size_t) LZ_MAGIC_LENGTH) == 0);
+    rewind (fp);
+    return result;
+}
+
+/* Checks that each block lies before the index and may be expanded into the
+ * buffer, and that each name lies within the names.
+ */
+static int validBlocks (const tagFile *const file, const unsigned long index,
+			const unsigned long blockLength)
+{
+    int result = (file->compressed.namesSize > 0  &&
+	file->compressed.names [file->compressed.namesSize - 1] == '\0');
+    unsigned long i;
+    for (i = 0  ;  result  &&  i < file->compressed.blockCount  ;  ++i)
+    {
+	const unsigned char *const entry = getBlockEntry (file, i);
+	const unsigned long size = getWord (entry + LZ_E_SIZE);
+	const unsigned long length = getWord (entry + LZ_E_LENGTH);
+	result = (withinFile (getWord (entry + LZ_E_OFFSET), size, 1, index)  &&
+		  size <= length  &&  length <= blockLength  &&
+		  getWord (entry + LZ_E_NAME) < file->compressed.namesSize);
+    }
+    return result;
+}
+
+/* Reads the header and index of a compressed tag file, leaving the file open
+ * to read blocks as they are needed.
+ */
+static int readCompressedTagFile (tagFile *const file,
+				  const char *const filePath)
+{
+    int result = 0;
+    unsigned char header [LZ_HEADER_SIZE];
+    FILE *const fp = fopen (filePath, "rb");
+    unsigned long length = 0;
+    if (fp != NULL)
+    {
+	file->compressed.fp = fp;
+	fseek (fp, 0, SEEK_END);
+	length = (unsigned long) ftell (fp);
+	rewind (fp);
+	if (fread (header, (size_t) 1, (size_t) LZ_HEADER_SIZE, fp)
+		== (size_t) LZ_HEADER_SIZE  &&
+	    getWord (header + LZ_H_VERSION) == LZ_VERSION)
+	    result = 1;
+    }
+    if (result)
+    {
+	const unsigned long index = getWord (header + LZ_H_INDEX);
+	const unsigned long blockLength = getWord (header + LZ_H_BLOCK_LENGTH);
+	unsigned long indexSize;
+
+	file->compressed.blockCount = getWord (header + LZ_H_BLOCK_COUNT);
+	file->compressed.namesSize  = getWord (header + LZ_H_NAMES_SIZE);
+	indexSize = file->compressed.blockCount * LZ_ENTRY_SIZE;
+	result = (withinFile (index, file->compressed.blockCount, LZ_ENTRY_SIZE,
+			      length)  &&
+		  withinFile (index + indexSize, file->compressed.namesSize, 1,
+			      length));
+	if (result)
+	{
+	    file->compressed.index = (unsigned char*) malloc (
+		    indexSize + file->compressed.namesSize + 1);
+	    file->compressed.input = (unsigned char*) malloc (blockLength + 1);
+	    file->compressed.text = (char*) malloc (blockLength + 1);
+	    if (file->compressed.index == NULL  ||
+		file->compressed.input == NULL  ||  file->compressed.text == NULL)
+	    {
+		perror (NULL);
+		result = 0;
+	    }
+	    else
+	    {
+		file->compressed.names =
+			(const char*) file->compressed.index + indexSize;
+		result = (fseek (fp, (long) index, SEEK_SET) == 0  &&
+		    fread (file->compressed.index, (size_t) 1,
+			   (size_t) (indexSize + file->compressed.namesSize),
+			   fp) == (size_t) (indexSize + file->compressed.namesSize)  &&
+		    validBlocks (file, index, blockLength));
+	    }
+	}
+    }
+    if (result)
+    {
+	file->compressed.block = file->compressed.blockCount;
+	loadBlock (file, 0);
+    }
+    return result;
+}
+
+static void freeCompressedTagFile (tagFile *const file)
+{
+    if (file->compressed.fp != NULL)
+	fclose (file->compressed.fp);
+    if (file->compressed.index != NULL)
+	free (file->compressed.index);
+    if (file->compressed.input != NULL)
+	free (file->compressed.input);
+    if (file->compressed.text != NULL)
+	free (file->compressed.text);
 }
 
 static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
@@ -460,6 +994,47 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 	    result = NULL;
 	    info->status.error_number = errno;
 	}
+	else if (isBinaryTagFile (result->fp))
+	{
+	    fclose (result->fp);
+	    result->fp = NULL;
+	    if (! readBinaryTagFile (result, filePath, info))
+	    {
+		info->status.error_number = EINVAL;
+		free (result->binary.data);
+		free (result->line.buffer);
+		free (result->name.buffer);
+		free (result->fields.list);
+		free (result);
+		result = NULL;
+	    }
+	    else
+	    {
+		info->status.opened = 1;
+		result->initialized = 1;
+	    }
+	}
+	else if (isCompressedTagFile (result->fp))
+	{
+	    fclose (result->fp);
+	    result->fp = NULL;
+	    if (! readCompressedTagFile (result, filePath))
+	    {
+		info->status.error_number = EINVAL;
+		freeCompressedTagFile (result);
+		free (result->line.buffer);
+		free (result->name.buffer);
+		free (result->fields.list);
+		free (result);
+		result = NULL;
+	    }
+	    else
+	    {
+		readPseudoTags (result, info);
+		info->status.opened = 1;
+		result->initialized = 1;
+	    }
+	}
 	else
 	{
 	    fseek (result->fp, 0, SEEK_END);
@@ -475,7 +1050,11 @@ static tagFile *initialize (const char *const filePath, tagFileInfo *const info)
 
 static void terminate (tagFile *const file)
 {
-    fclose (file->fp);
+    if (file->fp != NULL)
+	fclose (file->fp);
+    if (file->binary.data != NULL)
+	free (file->binary.data);
+    freeCompressedTagFile (file);
 
     free (file->line.buffer);
     free (file->name.buffer);
@@ -500,6 +1079,8 @@ static tagResult readNext (tagFile *const file, tagEntry *const entry)
     tagResult result = TagFailure;
     if (file == NULL  ||  ! file->initialized)
 	result = TagFailure;
+    else if (file->binary.data != NULL)
+	result = readNextBinary (file, entry);
     else if (! readTagLine (file))
 	result = TagFailure;
     else
@@ -538,28 +1119,33 @@ static int readTagLineSeek (tagFile *const file, const off_t pos)
     return result;
 }
 
-static int nameComparison (tagFile *const file)
+static int compareName (tagFile *const file, const char *const name)
 {
     int result;
     if (file->search.ignorecase)
     {
 	if (file->search.partial)
-	    result = strnuppercmp (file->search.name, file->name.buffer,
+	    result = strnuppercmp (file->search.name, name,
 		    file->search.nameLength);
 	else
-	    result = struppercmp (file->search.name, file->name.buffer);
+	    result = struppercmp (file->search.name, name);
     }
     else
     {
 	if (file->search.partial)
-	    result = strncmp (file->search.name, file->name.buffer,
+	    result = strncmp (file->search.name, name,
 		    file->search.nameLength);
 	else
-	    result = strcmp (file->search.name, file->name.buffer);
+	    result = strcmp (file->search.name, name);
     }
     return result;
 }
 
+static int nameComparison (tagFile *const file)
+{
+    return compareName (file, file->name.buffer);
+}
+
 static void findFirstNonMatchBefore (tagFile *const file)
 {
 #define JUMP_BACK 512
@@ -636,6 +1222,35 @@ static tagResult findBinary (tagFile *const file)
     return result;
 }
 
+/* Searches the index of a compressed tag file by bisection for the block in
+ * which the first match would be found (the last whose first tag precedes
+ * the name), then reads forward from there.
+ */
+static tagResult findBlock (tagFile *const file)
+{
+    tagResult result = TagFailure;
+    unsigned long lower = 0;
+    unsigned long upper = file->compressed.blockCount;
+    int comp = 1;
+    while (lower < upper)
+    {
+	const unsigned long middle = lower + (upper - lower) / 2;
+	const unsigned long name = getWord (getBlockEntry (file, middle) + LZ_E_NAME);
+	if (compareName (file, file->compressed.names + name) > 0)
+	    lower = middle + 1;
+	else
+	    upper = middle;
+    }
+    if (loadBlock (file, lower > 0 ? lower - 1 : 0))
+    {
+	while (comp > 0  &&  readTagLine (file))
+	    comp = nameComparison (file);
+	if (comp == 0)
+	    result = TagSuccess;
+    }
+    return result;
+}
+
 static tagResult findSequential (tagFile *const file)
 {
     tagResult result = TagFailure;
@@ -658,22 +1273,30 @@ static tagResult find (tagFile *const file, tagEntry *const entry,
     file->search.nameLength = strlen (name);
     file->search.partial = (options & TAG_PARTIALMATCH) != 0;
     file->search.ignorecase = (options & TAG_IGNORECASE) != 0;
-    fseek (file->fp, 0, SEEK_END);
-    file->size = ftell (file->fp);
-    rewind (file->fp);
+    if (file->fp != NULL)
+    {
+	fseek (file->fp, 0, SEEK_END);
+	file->size = ftell (file->fp);
+	rewind (file->fp);
+    }
     if ((file->sortMethod == TAG_SORTED      && !file->search.ignorecase) ||
 	(file->sortMethod == TAG_FOLDSORTED  &&  file->search.ignorecase))
     {
 #ifdef DEBUG
 	printf ("<performing binary search>\n");
 #endif
-	result = findBinary (file);
+	if (file->compressed.fp != NULL)
+	    result = findBlock (file);
+	else
+	    result = findBinary (file);
     }
     else
     {
 #ifdef DEBUG
 	printf ("<performing sequential search>\n");
 #endif
+	if (file->compressed.fp != NULL)
+	    loadBlock (file, 0);
 	result = findSequential (file);
     }
 
@@ -707,6 +1330,73 @@ static tagResult findNext (tagFile *const file, tagEntry *const entry)
     return result;
 }
 
+/* Searches the index from `position' for the next matching tag. */
+static tagResult findBinaryFrom (tagFile *const file, tagEntry *const entry,
+				 unsigned long position)
+{
+    tagResult result = TagFailure;
+    if (file->binary.ordered)
+    {
+	if (position < file->binary.indexCount  &&
+	    compareName (file, getRecordName (file,
+				getIndexedRecord (file, position))) == 0)
+	    result = TagSuccess;
+    }
+    else
+    {
+	while (position < file->binary.indexCount  &&
+	       compareName (file, getRecordName (file,
+				getIndexedRecord (file, position))) != 0)
+	    ++position;
+	if (position < file->binary.indexCount)
+	    result = TagSuccess;
+    }
+    if (result == TagSuccess)
+    {
+	unsigned long number = getIndexedRecord (file, position);
+	if (number >= file->binary.count)
+	    result = TagFailure;
+	else if (entry != NULL)
+	    parseBinaryRecord (file, number, entry);
+	file->binary.searchNext = position + 1;
+    }
+    else
+	file->binary.searchNext = file->binary.indexCount;
+    return result;
+}
+
+/* The index is ordered by name, observing case unless the tags were sorted
+ * ignoring case, so is searched by bisection if the search is in the same
+ * manner.
+ */
+static tagResult findInBinary (tagFile *const file, tagEntry *const entry,
+			      const char *const name, const int options)
+{
+    unsigned long lower = 0;
+    file->search.name = name;
+    file->search.nameLength = strlen (name);
+    file->search.partial = (options & TAG_PARTIALMATCH) != 0;
+    file->search.ignorecase = (options & TAG_IGNORECASE) != 0;
+    if ((file->binary.flags & BIN_FOLDCASE) != 0)
+	file->binary.ordered = file->search.ignorecase;
+    else
+	file->binary.ordered = ! file->search.ignorecase;
+    if (file->binary.ordered)
+    {
+	unsigned long upper = file->binary.indexCount;
+	while (lower < upper)
+	{
+	    const unsigned long middle = lower + (upper - lower) / 2;
+	    if (compareName (file, getRecordName (file,
+				getIndexedRecord (file, middle))) > 0)
+		lower = middle + 1;
+	    else
+		upper = middle;
+	}
+    }
+    return findBinaryFrom (file, entry, lower);
+}
+
 /*
 *  EXTERNAL INTERFACE
 */
@@ -732,7 +1422,10 @@ extern tagResult tagsFirst (tagFile *const file, tagEntry *const entry)
     tagResult result = TagFailure;
     if (file != NULL  &&  file->initialized)
     {
-	gotoFirstLogicalTag (file);
+	if (file->binary.data != NULL)
+	    file->binary.next = 0;
+	else
+	    gotoFirstLogicalTag (file);
 	result = readNext (file, entry);
     }
     return result;
@@ -758,7 +1451,11 @@ extern tagResult tagsFind (tagFile *const file, tagEntry *const entry,
 			   const char *const name, const int options)
 {
     tagResult result = TagFailure;
-    if (file != NULL  &&  file->initialized)
+    if (file == NULL  ||  ! file->initialized)
+	result = TagFailure;
+    else if (file->binary.data != NULL)
+	result = findInBinary (file, entry, name, options);
+    else
 	result = find (file, entry, name, options);
     return result;
 }
@@ -766,7 +1463,11 @@ extern tagResult tagsFind (tagFile *const file, tagEntry *const entry,
 extern tagResult tagsFindNext (tagFile *const file, tagEntry *const entry)
 {
     tagResult result = TagFailure;
-    if (file != NULL  &&  file->initialized)
+    if (file == NULL  ||  ! file->initialized)
+	result = TagFailure;
+    else if (file->binary.data != NULL)
+	result = findBinaryFrom (file, entry, file->binary.searchNext);
+    else
 	result = findNext (file, entry);
     return result;
 }
@@ -17,6 +17,15 @@
 *   to this approach permits a user to regenerate a tag file at will without
 *   the tool needing to detect and resynchronize with changes to the tag file.
 *   Even for an unsorted 24MB tag file, tag searches take about one second.
+*
+*   Binary tag databases (written by "ctags --output-format=bin") are also
+*   recognized. They are read into memory whole, and their index of tag names
+*   is searched by bisection whether or not the tags are sorted.
+*
+*   Compressed tag files (written by "ctags --compress") are read a block at
+*   a time. When the tags are sorted, the index of the first tag name in each
+*   block is searched by bisection, so that only the blocks holding matching
+*   tags are read and expanded.
 */
 #ifndef READTAGS_H
 #define READTAGS_H
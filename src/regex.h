@@ -16,6 +16,7 @@
 /* POSIX-style wrapper functions for ctags compatibility */
 typedef struct {
     regexp *prog;
+    int cflags;
 } regex_t;
 
 typedef struct {
@@ -28,6 +29,7 @@ int regcomp(regex_t *preg, const char *pattern, int cflags);
 int regexec(const regex_t *preg, const char *string, size_t nmatch, regmatch_t pmatch[], int eflags);
 void regfree(regex_t *preg);
 size_t regerror(int errcode, const regex_t *preg, char *errbuf, size_t errbuf_size);
+const char *regmust(const regex_t *preg);
 
 /* Implementation */
 int regcomp(regex_t *preg, const char *pattern, int cflags)
@@ -35,39 +37,41 @@ int regcomp(regex_t *preg, const char *pattern, int cflags)
     /* Ignore REG_EXTENDED flag since our implementation is basic */
     /* Also ignore REG_NEWLINE and REG_ICASE for now */
     preg->prog = RegComp((char*)pattern);
+    preg->cflags = cflags;
     return (preg->prog != NULL) ? 0 : 1;
 }
 
+/* The compiled program is not modified, so one regex_t may be used by any
+ * number of concurrent matches. */
 int regexec(const regex_t *preg, const char *string, size_t nmatch, regmatch_t pmatch[], int eflags)
 {
-    long result;
-    int i;
+    char *startp[NSUBEXP];
+    char *endp[NSUBEXP];
+    size_t i;
     
     if (!preg->prog) return 1;
     
-    result = RegExec(preg->prog, (char*)string);
-    if (result == 0) {
-        /* Match found - fill in pmatch if provided */
-        if (pmatch && nmatch > 0) {
-            /* Fill in all requested matches */
-            for (i = 0; i < nmatch && i < NSUBEXP; i++) {
-                if (preg->prog->startp[i] && preg->prog->endp[i]) {
-                    pmatch[i].rm_so = preg->prog->startp[i] - string;
-                    pmatch[i].rm_eo = preg->prog->endp[i] - string;
-                } else {
-                    pmatch[i].rm_so = -1;
-                    pmatch[i].rm_eo = -1;
-                }
-            }
-            /* Fill remaining matches as unused */
-            for (; i < nmatch; i++) {
+    if (RegExecCapture(preg->prog, string, startp, endp) != 0)
+        return 1;  /* No match */
+    
+    /* Match found - fill in pmatch if provided */
+    if (pmatch) {
+        for (i = 0; i < nmatch && i < NSUBEXP; i++) {
+            if (startp[i] && endp[i]) {
+                pmatch[i].rm_so = startp[i] - string;
+                pmatch[i].rm_eo = endp[i] - string;
+            } else {
                 pmatch[i].rm_so = -1;
                 pmatch[i].rm_eo = -1;
             }
         }
-        return 0;
+        /* Fill remaining matches as unused */
+        for (; i < nmatch; i++) {
+            pmatch[i].rm_so = -1;
+            pmatch[i].rm_eo = -1;
+        }
     }
-    return 1;  /* No match */
+    return 0;
 }
 
 void regfree(regex_t *preg)
@@ -78,6 +82,15 @@ void regfree(regex_t *preg)
     }
 }
 
+/* Literal string that any match must contain, or NULL if none is known.
+ * None is offered for REG_ICASE, which a literal search would not respect. */
+const char *regmust(const regex_t *preg)
+{
+    if (!preg->prog || (preg->cflags & REG_ICASE))
+        return NULL;
+    return RegMust(preg->prog);
+}
+
 size_t regerror(int errcode, const regex_t *preg, char *errbuf, size_t errbuf_size)
 {
     const char *errmsg = "Unknown regex error";
@@ -186,12 +186,26 @@ regexp *RegComp(char *exp)
 
 /* Execute function for static linking */
 long RegExec(regexp *prog, char *string)
+{
+    if (prog == NULL)
+        return(1);
+    return(RegExecCapture(prog, string, prog->startp, prog->endp));
+}
+
+/*
+ * Reentrant execute function: match positions are stored in the caller's
+ * startp[] and endp[] (each of NSUBEXP entries) rather than in the program,
+ * which is left unmodified, so that one compiled program may be used by
+ * several matches at once.
+ */
+long RegExecCapture(const regexp *prog, const char *string,
+                    char *startp[], char *endp[])
 {
     re_globals reglobs;
     char *s;
     
     /* Be paranoid... */
-    if (prog == NULL || string == NULL) {
+    if (prog == NULL || string == NULL || startp == NULL || endp == NULL) {
         return(1);
     }
     
@@ -202,7 +216,7 @@ long RegExec(regexp *prog, char *string)
     
     /* If there is a "must appear" string, look for it. */
     if (prog->regmust != NULL) {
-        s = string;
+        s = (char*)string;
         while ((s = strchr(s, prog->regmust[0])) != NULL) {
             if (strncmp(s, prog->regmust, prog->regmlen) == 0)
                 break;	/* Found it. */
@@ -212,15 +226,17 @@ long RegExec(regexp *prog, char *string)
             return(1);
     }
     
-    /* Mark beginning of line for ^ . */
-    reglobs.regbol = string;
+    /* Mark beginning of line for ^ , and where captures are to go. */
+    reglobs.regbol = (char*)string;
+    reglobs.regstartp = startp;
+    reglobs.regendp = endp;
     
     /* Simplest case:  anchored match need be tried only once. */
     if (prog->reganch)
-        return(regtry(&reglobs, prog, string));
+        return(regtry(&reglobs, prog, (char*)string) ? 0 : 1);
     
     /* Messy cases:  unanchored match. */
-    s = string;
+    s = (char*)string;
     if (prog->regstart)
         while ((s = strchr(s, prog->regstart)) != NULL) {
             if (regtry(&reglobs, prog, s))
@@ -237,6 +253,33 @@ long RegExec(regexp *prog, char *string)
     return(1);
 }
 
+/*
+ * Find the longest literal string that any match must include, as is done
+ * for regmust, but whether or not the r.e. contains anything expensive.
+ * Returns a pointer into the program (the string is NUL-terminated), or
+ * NULL if no such string is evident.
+ */
+char *RegMust(const regexp *prog)
+{
+    char *scan;
+    char *longest = NULL;
+    size_t len = 0;
+
+    if (prog == NULL || UCHARAT(prog->program) != MAGIC)
+        return(NULL);
+    if (prog->regmust != NULL)
+        return(prog->regmust);
+    scan = (char *)prog->program+1;		/* First BRANCH. */
+    if (OP(regnext(scan)) == END) {		/* Only one top-level choice. */
+        for (scan = OPERAND(scan); scan != NULL; scan = regnext(scan))
+            if (OP(scan) == EXACTLY && strlen(OPERAND(scan)) >= len) {
+                longest = OPERAND(scan);
+                len = strlen(OPERAND(scan));
+            }
+    }
+    return(longest);
+}
+
 /* Error translation function */
 char *RegXlatError(long err)
 {
@@ -655,18 +698,16 @@ static int regtry(re_globals *reglobs, const regexp *prog, char *string)
     char **ep;
 
     reglobs->reginput = string;
-    reglobs->regstartp = (char**)prog->startp;
-    reglobs->regendp = (char**)prog->endp;
 
-    sp = (char**)prog->startp;
-    ep = (char**)prog->endp;
+    sp = reglobs->regstartp;
+    ep = reglobs->regendp;
     for (i = NSUBEXP; i > 0; i--) {
         *sp++ = NULL;
         *ep++ = NULL;
     }
     if (regmatch(reglobs, (char*)prog->program + 1)) {
-        ((regexp *)prog)->startp[0] = string;
-        ((regexp *)prog)->endp[0] = reglobs->reginput;
+        reglobs->regstartp[0] = string;
+        reglobs->regendp[0] = reglobs->reginput;
         return TRUE;
     } else
         return FALSE;
@@ -774,6 +815,41 @@ static int regmatch(re_globals *reglobs, char *prog)
             return TRUE;	/* Success! */
             break;
         default:
+            if (OP(scan) > OPEN && OP(scan) < OPEN+NSUBEXP) {
+                long no;
+                char *save;
+
+                no = OP(scan) - OPEN;
+                save = reglobs->reginput;
+                if (regmatch(reglobs, (char*)next)) {
+                    /*
+                     * Don't set startp if some later
+                     * invocation of the same parentheses
+                     * already has.
+                     */
+                    if (reglobs->regstartp[no] == NULL)
+                        reglobs->regstartp[no] = save;
+                    return TRUE;
+                } else
+                    return FALSE;
+            } else if (OP(scan) > CLOSE && OP(scan) < CLOSE+NSUBEXP) {
+                long no;
+                char *save;
+
+                no = OP(scan) - CLOSE;
+                save = reglobs->reginput;
+                if (regmatch(reglobs, (char*)next)) {
+                    /*
+                     * Don't set endp if some later
+                     * invocation of the same parentheses
+                     * already has.
+                     */
+                    if (reglobs->regendp[no] == NULL)
+                        reglobs->regendp[no] = save;
+                    return TRUE;
+                } else
+                    return FALSE;
+            }
             return FALSE;
             break;
         }
@@ -62,6 +62,9 @@ typedef struct regexp {
 regexp *RegComp(char *exp);
 void RegFree(regexp *re);
 long RegExec(regexp *prog, char *string);
+long RegExecCapture(const regexp *prog, const char *string,
+                    char *startp[], char *endp[]);
+char *RegMust(const regexp *prog);
 char *RegXlatError(long err);
 
 #endif /* REGEXP_INTERNAL_H */
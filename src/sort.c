@@ -19,9 +19,13 @@
 #endif
 #include <string.h>
 #include <stdio.h>
+#include <ctype.h>
+#include <limits.h>	/* to define CHAR_MIN */
 
 #include "debug.h"
 #include "entry.h"
+#include "intern.h"
+#include "main.h"
 #include "options.h"
 #include "read.h"
 #include "routines.h"
@@ -50,6 +54,422 @@ extern void catFile (const char *const name)
     }
 }
 
+/*
+ *  These functions merge tag files which are already sorted (e.g. the output
+ *  of several ctags processes run with --shard) into a single sorted tag
+ *  file, without sorting them again.
+ */
+
+typedef struct sMergeInput {
+    const char *name;
+    FILE *fp;
+    vString *line;		/* current line; NULL once file is exhausted */
+    vString *previous;		/* previous line, to verify the sort order */
+} mergeInput;
+
+static int compareMergeLines (const char *const line1, const char *const line2)
+{
+    int result;
+    if (Option.sorted == SO_FOLDSORTED)
+	result = struppercmp (line1, line2);
+    else
+	result = strcmp (line1, line2);
+    return result;
+}
+
+static void nextMergeLine (mergeInput *const input)
+{
+    vString *const swap = input->previous;
+    const char *line;
+
+    input->previous = input->line;
+    input->line = swap;
+    do
+	line = readLine (input->line, input->fp);
+    while (line != NULL  &&  (*line == '\0'  ||  strcmp (line, "\n") == 0));
+
+    if (line == NULL)
+    {
+	vStringDelete (input->line);
+	input->line = NULL;
+    }
+    else if (vStringLength (input->previous) > 0  &&
+	     compareMergeLines (vStringValue (input->previous), line) > 0)
+	error (FATAL, "\"%s\" is not sorted as specified by --sort",
+	       input->name);
+}
+
+static boolean isPseudoTagLine (const char *const line)
+{
+    return (boolean) (strncmp (line, PSEUDO_TAG_PREFIX,
+			       strlen (PSEUDO_TAG_PREFIX)) == 0);
+}
+
+/*  Each input file carries its own copy of the pseudo tags, so only the first
+ *  line for each pseudo tag name is kept.
+ */
+static boolean isSamePseudoTag (const char *const line1, const char *const line2)
+{
+    const size_t length = strcspn (line1, "\t");
+    return (boolean) (isPseudoTagLine (line1)  &&  isPseudoTagLine (line2)  &&
+		      strncmp (line1, line2, length) == 0  &&
+		      (line2 [length] == '\t'  ||  line2 [length] == '\0'));
+}
+
+static FILE *openMergeOutput (const stringList *const files)
+{
+    FILE *fp;
+
+    if (isDestinationStdout ())
+	fp = stdout;
+    else
+    {
+	const char *name;
+
+	setDefaultTagFileName ();
+	name = Option.tagFileName;
+	if (stringListHas (files, name))
+	    error (FATAL, "cannot merge \"%s\" into itself", name);
+	if (! isTagFile (name))
+	    error (FATAL,
+	      "\"%s\" doesn't look like a tag file; I refuse to overwrite it.",
+		  name);
+	fp = fopen (name, "w");
+	if (fp == NULL)
+	    error (FATAL | PERROR, "cannot open tag file");
+    }
+    return fp;
+}
+
+extern void mergeTagFiles (const stringList *const files)
+{
+    const unsigned int count = stringListCount (files);
+    mergeInput *const inputs = xMalloc (count, mergeInput);
+    vString *const last = vStringNew ();	/* last line written */
+    FILE *fp;
+    unsigned int i;
+
+    for (i = 0  ;  i < count  ;  ++i)
+    {
+	mergeInput *const input = &inputs [i];
+	input->name = vStringValue (stringListItem (files, i));
+	input->fp = fopen (input->name, "r");
+	if (input->fp == NULL)
+	    error (FATAL | PERROR, "cannot open tag file \"%s\"", input->name);
+	input->line = vStringNew ();
+	input->previous = vStringNew ();
+	nextMergeLine (input);
+    }
+    fp = openMergeOutput (files);
+
+    /*	The number of inputs is expected to be small (one per process), so
+     *	the next line is found by simply examining the current line of each.
+     */
+    for (;;)
+    {
+	mergeInput *next = NULL;
+	const char *line;
+
+	for (i = 0  ;  i < count  ;  ++i)
+	{
+	    if (inputs [i].line != NULL  &&  (next == NULL  ||
+		compareMergeLines (vStringValue (inputs [i].line),
+				   vStringValue (next->line)) < 0))
+		next = &inputs [i];
+	}
+	if (next == NULL)
+	    break;
+	line = vStringValue (next->line);
+
+	/*  Apply the same rule as writeSortedTags() for identical lines.
+	 */
+	if (vStringLength (last) == 0  ||  (isPseudoTagLine (line) ?
+		! isSamePseudoTag (vStringValue (last), line) :
+		(Option.xref  ||  strcmp (line, vStringValue (last)) != 0)))
+	{
+	    if (fputs (line, fp) == EOF)
+		error (FATAL | PERROR, "cannot write merged tag file");
+	    vStringCopy (last, next->line);
+	}
+	nextMergeLine (next);
+    }
+
+    for (i = 0  ;  i < count  ;  ++i)
+    {
+	fclose (inputs [i].fp);
+	vStringDelete (inputs [i].line);
+	vStringDelete (inputs [i].previous);
+    }
+    eFree (inputs);
+    vStringDelete (last);
+    if (fp == stdout)
+	fflush (fp);
+    else if (fclose (fp) != 0)
+	error (FATAL | PERROR, "cannot write merged tag file");
+}
+
+/*
+ *  These functions sort tag lines held in memory. They are used by the
+ *  internal sort and to sort the tags of each file in filter mode.
+ *
+ *  To keep the cost of each comparison down, the first few characters of
+ *  each line (folded to upper case when required) are packed into an
+ *  integer key when the line is read. The lines are then distributed into
+ *  buckets by the first character of their key, and each bucket sorted
+ *  separately; most comparisons are decided by the keys alone. Lines which
+ *  compare equal keep their original relative order.
+ *
+ *  The internal sort holds every line of the tag file. Since the file name
+ *  field of a line is usually the same as that of many others, it is
+ *  removed from the line and replaced by an interned identifier, and the
+ *  lines are compared as if it were still in place.
+ */
+
+#define KEY_LENGTH	4	/* characters packed into a sort key */
+#define BUCKET_COUNT	256	/* one bucket for each leading key byte */
+
+typedef struct sSortEntry {
+    unsigned long key;		/* leading characters of line */
+    size_t index;		/* original position of line */
+    char *line;
+    unsigned int file;		/* file name removed from line (0 if none) */
+} sortEntry;
+
+/*  Reads the characters of a line as they were before its file name field
+ *  was removed.
+ */
+typedef struct sLineCursor {
+    const char *line;		/* next character of line */
+    const char *file;		/* next character of file name, if reading it */
+    unsigned int fileId;	/* file name yet to be read (0 if none) */
+} lineCursor;
+
+static void failedSort (FILE *const fp, const char* msg)
+{
+    const char* const cannotSort = "cannot sort tag file";
+    if (fp != NULL)
+	fclose (fp);
+    if (msg == NULL)
+	error (FATAL | PERROR, cannotSort);
+    else
+	error (FATAL, "%s: %s", msg, cannotSort);
+}
+
+/*  Maps a character to the byte used for it in a sort key, such that keys
+ *  order the same way as strcmp() (which compares unsigned characters) or
+ *  struppercmp() (which compares upper-cased plain characters) would.
+ */
+static unsigned int keyByte (const int c, const boolean folded)
+{
+    unsigned int result;
+    if (folded)
+	result = (unsigned int) (toupper ((int) (char) c) - CHAR_MIN) & 0xff;
+    else
+	result = (unsigned int) c & 0xff;
+    return result;
+}
+
+static unsigned long makeSortKey (const char *const line, const boolean folded)
+{
+    unsigned long key = 0;
+    boolean atEnd = FALSE;
+    int i;
+
+    for (i = 0  ;  i < KEY_LENGTH  ;  ++i)
+    {
+	unsigned int byte = 0;
+	if (! atEnd)
+	{
+	    byte = keyByte ((unsigned char) line [i], folded);
+	    atEnd = (boolean) (line [i] == '\0');
+	}
+	key = (key << 8) | byte;
+    }
+    return key;
+}
+
+static int nextLineChar (lineCursor *const cursor)
+{
+    int c;
+
+    if (cursor->file != NULL)
+    {
+	c = (unsigned char) *cursor->file++;
+	if (c == '\0')
+	{
+	    c = '\t';		/* separator following file name */
+	    cursor->file = NULL;
+	}
+    }
+    else
+    {
+	c = (unsigned char) *cursor->line;
+	if (c != '\0')
+	    ++cursor->line;
+	if (c == '\t'  &&  cursor->fileId != 0)
+	{
+	    cursor->file = internedString (cursor->fileId);
+	    cursor->fileId = 0;
+	}
+    }
+    return c;
+}
+
+/*  Compares two lines, one or both having had their file name removed, as
+ *  strcmp() or struppercmp() would compare the original lines.
+ */
+static int compareSplitLines (const sortEntry *const entry1,
+			      const sortEntry *const entry2,
+			      const boolean folded)
+{
+    lineCursor cursor1, cursor2;
+    int c1, c2;
+    int result;
+
+    cursor1.line = entry1->line;
+    cursor1.file = NULL;
+    cursor1.fileId = entry1->file;
+    cursor2.line = entry2->line;
+    cursor2.file = NULL;
+    cursor2.fileId = entry2->file;
+    do
+    {
+	c1 = nextLineChar (&cursor1);
+	c2 = nextLineChar (&cursor2);
+	if (folded)
+	    result = toupper ((int) (char) c1) - toupper ((int) (char) c2);
+	else
+	    result = c1 - c2;
+    } while (result == 0  &&  c1 != '\0');
+    return result;
+}
+
+static int compareEntries (const sortEntry *const entry1,
+			   const sortEntry *const entry2,
+			   const boolean folded)
+{
+    int result;
+
+    if (entry1->key != entry2->key)
+	result = entry1->key < entry2->key ? -1 : 1;
+    else
+    {
+	if (entry1->file != 0  ||  entry2->file != 0)
+	    result = compareSplitLines (entry1, entry2, folded);
+	else if (folded)
+	    result = struppercmp (entry1->line, entry2->line);
+	else
+	    result = strcmp (entry1->line, entry2->line);
+	if (result == 0)
+	    result = entry1->index < entry2->index ? -1 : 1;
+    }
+    return result;
+}
+
+static int compareTagsFolded (const void *const one, const void *const two)
+{
+    return compareEntries ((const sortEntry *) one, (const sortEntry *) two,
+			   TRUE);
+}
+
+static int compareTags (const void *const one, const void *const two)
+{
+    return compareEntries ((const sortEntry *) one, (const sortEntry *) two,
+			   FALSE);
+}
+
+/*  Are the lines of two entries identical?
+ */
+static boolean isSameLine (const sortEntry *const entry1,
+			   const sortEntry *const entry2)
+{
+    return (boolean) (entry1->file == entry2->file  &&
+		      strcmp (entry1->line, entry2->line) == 0);
+}
+
+/*  Sorts the entries, first distributing them into buckets according to the
+ *  first byte of their keys (preserving their order), then sorting each
+ *  bucket.
+ */
+static void sortEntries (sortEntry *const entries, const size_t numTags,
+			 const boolean folded)
+{
+    int (*const cmpFunc)(const void *, const void *) =
+	    folded ? compareTagsFolded : compareTags;
+    const int shift = 8 * (KEY_LENGTH - 1);
+    size_t start [BUCKET_COUNT + 1];
+    sortEntry *sorted;
+    size_t i;
+    int b;
+
+    sorted = (sortEntry *) malloc (numTags * sizeof (sortEntry) + 1);
+    if (sorted == NULL)
+	failedSort (NULL, "out of memory");
+
+    memset (start, 0, sizeof (start));
+    for (i = 0  ;  i < numTags  ;  ++i)
+	++start [(entries [i].key >> shift) + 1];
+    for (b = 0  ;  b < BUCKET_COUNT  ;  ++b)
+	start [b + 1] += start [b];
+    for (i = 0  ;  i < numTags  ;  ++i)
+	sorted [start [entries [i].key >> shift]++] = entries [i];
+
+    /*	Each start [b] now marks the end of bucket b.
+     */
+    for (b = 0  ;  b < BUCKET_COUNT  ;  ++b)
+    {
+	const size_t first = b == 0 ? 0 : start [b - 1];
+	if (start [b] - first > 1)
+	    qsort (sorted + first, start [b] - first, sizeof (*sorted), cmpFunc);
+    }
+    memcpy (entries, sorted, numTags * sizeof (*sorted));
+    free (sorted);
+}
+
+/*  Sorts the tag lines held in a buffer (each terminated by a newline),
+ *  removing duplicate lines as when sorting a tag file. Used in filter mode,
+ *  where the tags of each file are written to stdout without a tag file.
+ */
+extern void sortTagBuffer (vString *const buffer)
+{
+    const boolean folded = (boolean) (Option.sorted == SO_FOLDSORTED);
+    sortEntry *entries;
+    char *text;
+    size_t numTags = 0;
+    size_t i;
+    char *p;
+
+    vStringTerminate (buffer);
+    text = eStrdup (vStringValue (buffer));
+    for (p = text  ;  *p != '\0'  ;  ++p)
+	if (*p == '\n')
+	    ++numTags;
+    entries = xMalloc (numTags + 1, sortEntry);
+    for (p = text, i = 0  ;  i < numTags  ;  ++i)
+    {
+	char *const end = strchr (p, '\n');
+	*end = '\0';
+	entries [i].key   = makeSortKey (p, folded);
+	entries [i].index = i;
+	entries [i].line  = p;
+	entries [i].file  = 0;
+	p = end + 1;
+    }
+    sortEntries (entries, numTags, folded);
+
+    vStringClear (buffer);
+    for (i = 0  ;  i < numTags  ;  ++i)
+    {
+	if (i == 0  ||  Option.xref  ||  ! isSameLine (&entries [i], &entries [i-1]))
+	{
+	    vStringCatS (buffer, entries [i].line);
+	    vStringPut (buffer, '\n');
+	}
+    }
+    eFree (entries);
+    eFree (text);
+}
+
 #ifdef EXTERNAL_SORT
 
 #ifdef NON_CONST_PUTENV_PROTOTYPE
@@ -108,35 +528,87 @@ extern void externalSortTags (const boolean toStdout)
  *  so have lots of memory if you have large tag files.
  */
 
-static void failedSort (FILE *const fp, const char* msg)
+#define LINE_BLOCK_SIZE	65536	/* size of blocks holding lines */
+
+/*  Lines are held in large blocks to avoid the overhead of allocating each
+ *  one separately.
+ */
+typedef struct sLineBlock {
+    struct sLineBlock *next;
+    size_t used;
+    size_t size;
+    char text [1];		/* actually `size' characters */
+} lineBlock;
+
+static char *allocateLine (lineBlock **const blocks, const size_t length)
 {
-    const char* const cannotSort = "cannot sort tag file";
-    if (fp != NULL)
-	fclose (fp);
-    if (msg == NULL)
-	error (FATAL | PERROR, cannotSort);
-    else
-	error (FATAL, "%s: %s", msg, cannotSort);
+    char *result;
+
+    if (*blocks == NULL  ||  (*blocks)->size - (*blocks)->used < length)
+    {
+	const size_t size = (length > LINE_BLOCK_SIZE) ? length : LINE_BLOCK_SIZE;
+	lineBlock *const block = (lineBlock *) malloc (sizeof (lineBlock) + size);
+	if (block == NULL)
+	    failedSort (NULL, "out of memory");
+	block->next = *blocks;
+	block->used = 0;
+	block->size = size;
+	*blocks = block;
+    }
+    result = (*blocks)->text + (*blocks)->used;
+    (*blocks)->used += length;
+    return result;
 }
 
-static int compareTagsFolded(const void *const one, const void *const two)
+/*  Stores a line for an entry, removing its file name field (the text
+ *  between the first and second tabs), which is interned instead.
+ */
+static void storeLine (sortEntry *const entry, char *const line,
+		       lineBlock **const blocks)
 {
-    const char *const line1 = *(const char* const*) one;
-    const char *const line2 = *(const char* const*) two;
+    char *const tab1 = strchr (line, '\t');
+    char *const tab2 = (tab1 == NULL) ? NULL : strchr (tab1 + 1, '\t');
 
-    return struppercmp (line1, line2);
+    if (tab2 == NULL)
+    {
+	entry->file = 0;
+	entry->line = allocateLine (blocks, strlen (line) + 1);
+	strcpy (entry->line, line);
+    }
+    else
+    {
+	const size_t nameLength = tab1 - line + 1;	/* including tab */
+
+	*tab2 = '\0';
+	entry->file = internString (tab1 + 1);
+	entry->line = allocateLine (blocks, nameLength + strlen (tab2 + 1) + 1);
+	memcpy (entry->line, line, nameLength);
+	strcpy (entry->line + nameLength, tab2 + 1);
+    }
 }
 
-static int compareTags (const void *const one, const void *const two)
+static void writeSortedLine (const sortEntry *const entry, FILE *const fp)
 {
-    const char *const line1 = *(const char* const*) one;
-    const char *const line2 = *(const char* const*) two;
+    const char *const tab = strchr (entry->line, '\t');
+    boolean ok;
 
-    return strcmp (line1, line2);
+    if (entry->file == 0  ||  tab == NULL)
+	ok = (boolean) (fputs (entry->line, fp) != EOF);
+    else
+    {
+	const size_t nameLength = tab - entry->line + 1;
+	ok = (boolean) (
+		fwrite (entry->line, (size_t) 1, nameLength, fp) == nameLength  &&
+		fputs (internedString (entry->file), fp) != EOF  &&
+		putc ('\t', fp) != EOF  &&
+		fputs (tab + 1, fp) != EOF);
+    }
+    if (! ok)
+	failedSort (fp, NULL);
 }
 
-static void writeSortedTags (char **const table, const size_t numTags,
-			     const boolean toStdout)
+static void writeSortedTags (const sortEntry *const entries,
+			     const size_t numTags, const boolean toStdout)
 {
     FILE *fp;
     size_t i;
@@ -156,9 +628,8 @@ static void writeSortedTags (char **const table, const size_t numTags,
 	/*  Here we filter out identical tag *lines* (including search
 	 *  pattern) if this is not an xref file.
 	 */
-	if (i == 0  ||  Option.xref  ||  strcmp (table [i], table [i-1]) != 0)
-	    if (fputs (table [i], fp) == EOF)
-		failedSort (fp, NULL);
+	if (i == 0  ||  Option.xref  ||  ! isSameLine (&entries [i], &entries [i-1]))
+	    writeSortedLine (&entries [i], fp);
     }
     if (toStdout)
 	fflush (fp);
@@ -172,18 +643,16 @@ extern void internalSortTags (const boolean toStdout)
     FILE *fp = NULL;
     const char *line;
     size_t i;
-    int (*cmpFunc)(const void *, const void *);
+    const boolean folded = (boolean) (Option.sorted == SO_FOLDSORTED);
+    lineBlock *blocks = NULL;
 
-    /*	Allocate a table of line pointers to be sorted.
+    /*	Allocate a table of entries to be sorted.
      */
     size_t numTags = TagFile.numTags.added + TagFile.numTags.prev;
-    const size_t tableSize = numTags * sizeof (char *);
-    char **const table = (char **) malloc (tableSize);	/* line pointers */
-    DebugStatement ( size_t mallocSize = tableSize; )	/* cumulative total */
+    const size_t entriesSize = numTags * sizeof (sortEntry);
+    sortEntry *const entries = (sortEntry *) malloc (entriesSize + 1);
 
-
-    cmpFunc = Option.sorted == SO_FOLDSORTED ? compareTagsFolded : compareTags;
-    if (table == NULL)
+    if (entries == NULL)
 	failedSort (fp, "out of memory");
 
     /*	Open the tag file and place its lines into allocated buffers.
@@ -204,13 +673,9 @@ extern void internalSortTags (const boolean toStdout)
 	    ;		/* ignore blank lines */
 	else
 	{
-	    const size_t stringSize = strlen (line) + 1;
-
-	    table [i] = (char *) malloc (stringSize);
-	    if (table [i] == NULL)
-		failedSort (fp, "out of memory");
-	    DebugStatement ( mallocSize += stringSize; )
-	    strcpy (table [i], line);
+	    entries [i].key   = makeSortKey (line, folded);
+	    entries [i].index = i;
+	    storeLine (&entries [i], vStringValue (vLine), &blocks);
 	    ++i;
 	}
     }
@@ -220,14 +685,17 @@ extern void internalSortTags (const boolean toStdout)
 
     /*	Sort the lines.
      */
-    qsort (table, numTags, sizeof (*table), cmpFunc);
+    sortEntries (entries, numTags, folded);
 
-    writeSortedTags (table, numTags, toStdout);
+    writeSortedTags (entries, numTags, toStdout);
 
-    PrintStatus (("sort memory: %ld bytes\n", (long) mallocSize));
-    for (i = 0 ; i < numTags ; ++i)
-	free (table [i]);
-    free (table);
+    free (entries);
+    while (blocks != NULL)
+    {
+	lineBlock *const next = blocks->next;
+	free (blocks);
+	blocks = next;
+    }
 }
 
 #endif
@@ -16,10 +16,15 @@
 */
 #include "general.h"	/* must always come first */
 
+#include "strlist.h"
+#include "vstring.h"
+
 /*
 *   FUNCTION PROTOTYPES
 */
 extern void catFile (const char *const name);
+extern void mergeTagFiles (const stringList *const files);
+extern void sortTagBuffer (vString *const buffer);
 
 #ifdef EXTERNAL_SORT
 extern void externalSortTags (const boolean toStdout);
@@ -3,9 +3,10 @@
 # Shared macros
 
 HEADERS = \
-	args.h ctags.h debug.h entry.h general.h get.h keyword.h \
-	main.h options.h parse.h parsers.h read.h routines.h sort.h \
-	strlist.h vstring.h
+	args.h binfmt.h bintags.h ctags.h debug.h dedup.h entry.h general.h \
+	get.h intern.h keyword.h lexer.h lzfmt.h lztags.h main.h options.h \
+	parse.h parsers.h profile.h read.h routines.h sort.h strlist.h \
+	trace.h vstring.h watch.h
 
 SOURCES = \
 	args.c \
@@ -13,19 +14,24 @@ SOURCES = \
 	asp.c \
 	awk.c \
 	beta.c \
+	bintags.c \
 	c.c \
 	cobol.c \
+	dedup.c \
 	eiffel.c \
 	entry.c \
 	erlang.c \
 	fortran.c \
 	get.c \
 	html.c \
+	intern.c \
 	jscript.c \
 	keyword.c \
+	lexer.c \
 	lisp.c \
 	lregex.c \
 	lua.c \
+	lztags.c \
 	main.c \
 	make.c \
 	options.c \
@@ -33,6 +39,7 @@ SOURCES = \
 	pascal.c \
 	perl.c \
 	php.c \
+	profile.c \
 	python.c \
 	read.c \
 	rexx.c \
@@ -46,8 +53,10 @@ SOURCES = \
 	sql.c \
 	strlist.c \
 	tcl.c \
+	trace.c \
 	verilog.c \
 	vim.c \
+	watch.c \
 	yacc.c \
 	vstring.c
 
@@ -63,19 +72,24 @@ OBJECTS = \
 	asp.$(OBJEXT) \
 	awk.$(OBJEXT) \
 	beta.$(OBJEXT) \
+	bintags.$(OBJEXT) \
 	c.$(OBJEXT) \
 	cobol.$(OBJEXT) \
+	dedup.$(OBJEXT) \
 	eiffel.$(OBJEXT) \
 	entry.$(OBJEXT) \
 	erlang.$(OBJEXT) \
 	fortran.$(OBJEXT) \
 	get.$(OBJEXT) \
 	html.$(OBJEXT) \
+	intern.$(OBJEXT) \
 	jscript.$(OBJEXT) \
 	keyword.$(OBJEXT) \
+	lexer.$(OBJEXT) \
 	lisp.$(OBJEXT) \
 	lregex.$(OBJEXT) \
 	lua.$(OBJEXT) \
+	lztags.$(OBJEXT) \
 	main.$(OBJEXT) \
 	make.$(OBJEXT) \
 	options.$(OBJEXT) \
@@ -83,6 +97,7 @@ OBJECTS = \
 	pascal.$(OBJEXT) \
 	perl.$(OBJEXT) \
 	php.$(OBJEXT) \
+	profile.$(OBJEXT) \
 	python.$(OBJEXT) \
 	read.$(OBJEXT) \
 	rexx.$(OBJEXT) \
@@ -96,8 +111,10 @@ OBJECTS = \
 	sql.$(OBJEXT) \
 	strlist.$(OBJEXT) \
 	tcl.$(OBJEXT) \
+	trace.$(OBJEXT) \
 	verilog.$(OBJEXT) \
 	vim.$(OBJEXT) \
+	watch.$(OBJEXT) \
 	yacc.$(OBJEXT) \
 	vstring.$(OBJEXT)
 
@@ -8,6 +8,10 @@
 *
 *   This module contains functions for generating tags for PL/SQL language
 *   files.
+*
+*   Database dumps are mostly data, in INSERT statements and in the data
+*   blocks following "COPY ... FROM stdin;". Neither defines anything, so
+*   both are passed over by a bulk scan instead of being read as tokens.
 */
 
 /*
@@ -15,12 +19,13 @@
 */
 #include "general.h"	/* must always come first */
 
-#include <ctype.h>	/* to define isalpha () */
+#include <ctype.h>	/* to define isspace () */
 #include <setjmp.h>
 
 #include "debug.h"
 #include "entry.h"
 #include "keyword.h"
+#include "lexer.h"
 #include "parse.h"
 #include "read.h"
 #include "routines.h"
@@ -39,6 +44,7 @@
 */
 #define isType(token,t)		(boolean) ((token)->type == (t))
 #define isKeyword(token,k)	(boolean) ((token)->keyword == (k))
+#define isIdentChar1(c)		lexIsClass (SqlClasses, c, LEX_IDENT_START)
 
 /*
 *   DATA DECLARATIONS
@@ -53,11 +59,13 @@ typedef enum eKeywordId {
     KEYWORD_is,
     KEYWORD_begin,
     KEYWORD_body,
+    KEYWORD_copy,
     KEYWORD_cursor,
     KEYWORD_declare,
     KEYWORD_end,
     KEYWORD_function,
     KEYWORD_if,
+    KEYWORD_insert,
     KEYWORD_loop,
     KEYWORD_package,
     KEYWORD_pragma,
@@ -69,7 +77,8 @@ typedef enum eKeywordId {
     KEYWORD_subtype,
     KEYWORD_table,
     KEYWORD_trigger,
-    KEYWORD_type
+    KEYWORD_type,
+    KEYWORD_view
 } keywordId;
 
 /*  Used to determine whether keyword is valid for the token language and
@@ -108,6 +117,10 @@ static langType Lang_sql;
 
 static jmp_buf Exception;
 
+static lexClassTable SqlClasses;
+static lexPool *Tokens = NULL;	/* released tokens, for reuse */
+static boolean BackslashEscapes = FALSE;	/* does a backslash escape in strings? */
+
 typedef enum {
     SQLTAG_CURSOR,
     SQLTAG_PROTOTYPE,
@@ -121,6 +134,7 @@ typedef enum {
     SQLTAG_TABLE,
     SQLTAG_TRIGGER,
     SQLTAG_VARIABLE,
+    SQLTAG_VIEW,
     SQLTAG_COUNT
 } sqlKind;
 
@@ -137,6 +151,7 @@ static kindOption SqlKinds [] = {
     { TRUE,  't', "table",     "tables"		},
     { TRUE,  'T', "trigger",   "triggers"	},
     { TRUE,  'v', "variable",  "variables"	},
+    { TRUE,  'V', "view",      "views"		},
 };
 
 static const keywordDesc SqlKeywordTable [] = {
@@ -144,11 +159,13 @@ static const keywordDesc SqlKeywordTable [] = {
     { "as",		KEYWORD_is		},
     { "begin",		KEYWORD_begin		},
     { "body",		KEYWORD_body		},
+    { "copy",		KEYWORD_copy		},
     { "cursor",		KEYWORD_cursor		},
     { "declare",	KEYWORD_declare		},
     { "end",		KEYWORD_end		},
     { "function",	KEYWORD_function	},
     { "if",		KEYWORD_if		},
+    { "insert",		KEYWORD_insert		},
     { "is",		KEYWORD_is		},
     { "loop",		KEYWORD_loop		},
     { "package",	KEYWORD_package		},
@@ -161,7 +178,8 @@ static const keywordDesc SqlKeywordTable [] = {
     { "subtype",	KEYWORD_subtype		},
     { "table",		KEYWORD_table		},
     { "trigger",	KEYWORD_trigger		},
-    { "type",		KEYWORD_type		}
+    { "type",		KEYWORD_type		},
+    { "view",		KEYWORD_view		}
 };
 
 /*
@@ -174,17 +192,6 @@ static void parseBlock (tokenInfo *const token, const boolean local);
 *   FUNCTION DEFINITIONS
 */
 
-static boolean isIdentChar1 (const int c)
-{
-    return (boolean) isalpha (c);
-}
-
-static boolean isIdentChar (const int c)
-{
-    return (boolean)
-	(isalpha (c) || isdigit (c) || c == '$' || c == '_' || c == '#');
-}
-
 static void buildSqlKeywordHash (void)
 {
     const size_t count = sizeof (SqlKeywordTable) /
@@ -199,21 +206,33 @@ static void buildSqlKeywordHash (void)
 
 static tokenInfo *newToken (void)
 {
-    tokenInfo *const token = xMalloc (1, tokenInfo);
+    tokenInfo *token = lexPoolGet (Tokens);
 
+    if (token == NULL)
+    {
+	token = xMalloc (1, tokenInfo);
+	token->string = vStringNew ();
+    }
+    else
+	vStringClear (token->string);
     token->type         = TOKEN_UNDEFINED;
     token->keyword      = KEYWORD_NONE;
-    token->string       = vStringNew ();
 
     return token;
 }
 
-static void deleteToken (tokenInfo *const token)
+static void destroyToken (void *const object)
 {
+    tokenInfo *const token = (tokenInfo *) object;
     vStringDelete (token->string);
     eFree (token);
 }
 
+static void deleteToken (tokenInfo *const token)
+{
+    lexPoolPut (Tokens, token);
+}
+
 /*
 *   Tag generation functions
 */
@@ -239,54 +258,143 @@ static void makeSqlTag (tokenInfo *const token, const sqlKind kind)
 
 static int skipToCharacter (const int c)
 {
+    char stops [2];
     int d;
+    stops [0] = (char) c;
+    stops [1] = '\0';
     do
     {
+	fileSkipToCharacter (stops);
 	d = fileGetc ();
     } while (d != EOF  &&  d != c);
     return d;
 }
 
-static void parseString (vString *const string, const int delimiter)
+static void skipComment (void)
 {
+    int c;
+    do
+    {
+	skipToCharacter ('*');
+	c = fileGetc ();
+	if (c != '/'  &&  c != EOF)
+	    fileUngetc (c);
+    } while (c != '/'  &&  c != EOF);
+}
+
+/*  Skips a quoted string or identifier, whose opening quote has been read,
+ *  returning whether the end of the statement was taken to be found within
+ *  it. A backslash escapes the following character in a PostgreSQL E'...'
+ *  string ("extended"), and in any string once identifiers quoted with '`'
+ *  have shown the file to be written for MySQL, whose dumps escape quotes in
+ *  this way. Should an extended string be mistaken, its closing quote taken
+ *  to be escaped, it is ended by a ';' which ends a line. Other strings may
+ *  well hold such a ';' (as in stored SQL text), so nothing else ends them.
+ */
+static boolean skipQuoted (const int delimiter, const boolean extended)
+{
+    const boolean escapes = (boolean) (extended  ||
+				       (BackslashEscapes  &&  delimiter != '`'));
     boolean end = FALSE;
+    char stops [4];
+    int i = 0;
     int c;
-    while (! end)
+    stops [i++] = (char) delimiter;
+    if (escapes)
+	stops [i++] = '\\';
+    if (extended)
+	stops [i++] = ';';
+    stops [i] = '\0';
+    do
     {
+	fileSkipToCharacter (stops);
 	c = fileGetc ();
-	if (c == EOF)
-	    end = TRUE;
+	if (c == '\\'  &&  escapes)
+	    c = fileGetc ();	/* throw away next character, too */
+	else if (c == ';'  &&  extended)
+	{
+	    const int d = fileGetc ();
+	    end = (boolean) (d == '\n'  ||  d == EOF);
+	    if (! end)
+		fileUngetc (d);
+	}
 	else if (c == delimiter)
-	    end = TRUE;
-	else
-	    vStringPut (string, c);
-    }
-    vStringTerminate (string);
+	    break;
+    } while (c != EOF  &&  ! end);
+    return end;
 }
 
-/*  Read a C identifier beginning with "firstChar" and places it into "name".
+/*  Skips to the end of a statement, without reading its tokens.
  */
-static void parseIdentifier (vString *const string, const int firstChar)
+static void skipStatement (void)
 {
-    int c = firstChar;
-    Assert (isIdentChar1 (c));
+    boolean end = FALSE;
+    int c;
     do
     {
-	vStringPut (string, c);
+	const int last = fileSkipToCharacter (";'\"`-/");
 	c = fileGetc ();
-    } while (isIdentChar (c));
-    vStringTerminate (string);
+	if (c == '`')
+	    BackslashEscapes = TRUE;
+	if (c == '\''  ||  c == '"'  ||  c == '`')
+	    end = skipQuoted (c, (boolean) (c == '\''  &&
+					    (last == 'E'  ||  last == 'e')));
+	else if (c == '-'  ||  c == '/')
+	{
+	    const int d = fileGetc ();
+	    if (c == '-'  &&  d == '-')
+		skipToCharacter ('\n');
+	    else if (c == '/'  &&  d == '*')
+		skipComment ();
+	    else
+		fileUngetc (d);
+	}
+    } while (c != EOF  &&  c != ';'  &&  ! end);
+}
+
+/*  Skips the lines of data following "COPY ... FROM stdin;", up to and
+ *  including the line "\." which ends them.
+ */
+static void skipCopyData (void)
+{
+    boolean end = FALSE;
+    int c = skipToCharacter ('\n');
+    while (! end  &&  c != EOF)
+    {
+	c = fileGetc ();
+	if (c == '\\'  &&  (c = fileGetc ()) == '.')
+	{
+	    c = fileGetc ();
+	    end = (boolean) (c == '\n'  ||  c == EOF);
+	}
+	if (! end  &&  c != '\n'  &&  c != EOF)
+	    c = skipToCharacter ('\n');
+    }
+}
+
+static void parseString (vString *const string, const int delimiter)
+{
+    char stops [2];
+    stops [0] = (char) delimiter;
+    stops [1] = '\0';
+    fileGetToCharacter (string, stops);
+}
+
+/*  Read a C identifier beginning with "firstChar" and places it into "name".
+ */
+static void parseIdentifier (vString *const string, const int firstChar)
+{
+    int c;
+    Assert (isIdentChar1 (firstChar));
+    vStringPut (string, firstChar);
+    c = fileGetSpan (string, SqlClasses, LEX_IDENT);
     if (!isspace (c))
 	fileUngetc (c);		/* unget non-identifier character */
 }
 
 static keywordId analyzeToken (vString *const name)
 {
-    static vString *keyword = NULL;
-    if (keyword == NULL)
-	keyword = vStringNew ();
-    vStringCopyToLower (keyword, name);
-    return (keywordId) lookupKeyword (vStringValue (keyword), Lang_sql);
+    return (keywordId) lexLookupKeyword (name, Lang_sql);
 }
 
 static void readToken (tokenInfo *const token)
@@ -298,9 +406,7 @@ static void readToken (tokenInfo *const token)
     vStringClear (token->string);
 
 getNextChar:
-    do
-	c = fileGetc ();
-    while (c == '\t'  ||  c == ' '  ||  c == '\n');
+    c = fileGetSpan (NULL, SqlClasses, LEX_SPACE);
 
     switch (c)
     {
@@ -338,15 +444,7 @@ getNextChar:
 		fileUngetc (d);
 	    else
 	    {
-		do
-		{
-		    skipToCharacter ('*');
-		    c = fileGetc ();
-		    if (c == '/')
-			break;
-		    else
-			fileUngetc (c);
-		} while (c != '\0');
+		skipComment ();
 		goto getNextChar;
 	    }
 	    break;
@@ -567,6 +665,32 @@ static void parseTable (tokenInfo *const token)
     deleteToken (name);
 }
 
+static void parseView (tokenInfo *const token)
+{
+    tokenInfo *const name = newToken ();
+    readToken (name);
+    readToken (token);
+    skipArgumentList (token);
+    if (isKeyword (token, KEYWORD_is)  &&  isType (name, TOKEN_IDENTIFIER))
+	makeSqlTag (name, SQLTAG_VIEW);
+    findToken (token, TOKEN_SEMICOLON);
+    deleteToken (name);
+}
+
+static void parseCopy (tokenInfo *const token)
+{
+    boolean fromInput = FALSE;
+    do
+    {
+	readToken (token);
+	if (isType (token, TOKEN_IDENTIFIER)  &&
+	    struppercmp (vStringValue (token->string), "STDIN") == 0)
+	    fromInput = TRUE;
+    } while (! isType (token, TOKEN_SEMICOLON));
+    if (fromInput)
+	skipCopyData ();
+}
+
 static void parseSqlFile (tokenInfo *const token)
 {
     do
@@ -574,15 +698,18 @@ static void parseSqlFile (tokenInfo *const token)
 	readToken (token);
 	switch (token->keyword)
 	{
+	    case KEYWORD_copy:      parseCopy (token); break;
 	    case KEYWORD_cursor:    parseSimple (token, SQLTAG_CURSOR); break;
 	    case KEYWORD_declare:   parseBlock (token, FALSE); break;
 	    case KEYWORD_function:  parseSubProgram (token); break;
+	    case KEYWORD_insert:    skipStatement (); break;
 	    case KEYWORD_package:   parsePackage (token); break;
 	    case KEYWORD_procedure: parseSubProgram (token); break;
 	    case KEYWORD_subtype:   parseSimple (token, SQLTAG_SUBTYPE); break;
 	    case KEYWORD_table:     parseTable (token); break;
 	    case KEYWORD_trigger:   parseSimple (token, SQLTAG_TRIGGER); break;
 	    case KEYWORD_type:      parseType (token); break;
+	    case KEYWORD_view:      parseView (token); break;
 	    default:                break;
 	}
     } while (! isKeyword (token, KEYWORD_end));
@@ -593,15 +720,25 @@ static void initialize (const langType language)
     Assert (sizeof (SqlKinds) / sizeof (SqlKinds [0]) == SQLTAG_COUNT);
     Lang_sql = language;
     buildSqlKeywordHash ();
+    lexSetClass (SqlClasses, " \t\n", LEX_SPACE);
+    lexSetClass (SqlClasses, LEX_LETTERS, LEX_IDENT_START | LEX_IDENT);
+    lexSetClass (SqlClasses, LEX_DIGITS "$_#", LEX_IDENT);
 }
 
 static void findSqlTags (void)
 {
-    tokenInfo *const token = newToken ();
-    exception_t exception = (exception_t) (setjmp (Exception));
+    tokenInfo *token;
+    exception_t exception;
+
+    Tokens = lexPoolNew (destroyToken);
+    BackslashEscapes = FALSE;
+    token = newToken ();
+    exception = (exception_t) (setjmp (Exception));
     while (exception == ExceptionNone)
 	parseSqlFile (token);
     deleteToken (token);
+    lexPoolDelete (Tokens);
+    Tokens = NULL;
 }
 
 extern parserDefinition* SqlParser (void)
@@ -0,0 +1,145 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for recording begin and end events around
+*   the main activities of a run, and for writing them for the --trace option
+*   in the Chrome trace event format (viewable in chrome://tracing, Perfetto
+*   and similar tools).
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+
+#include "options.h"
+#include "profile.h"
+#include "routines.h"
+#include "trace.h"
+
+/*
+*   MACROS
+*/
+#define TRACE_CAPACITY	(1UL << 18)	/* events kept in ring buffer */
+
+/*
+*   DATA DECLARATIONS
+*/
+typedef struct sTraceRecord {
+    double time;		/* seconds since first event */
+    const char *category;	/* static string */
+    const char *name;		/* static string */
+    char *detail;		/* copy of detail string, or NULL */
+    int phase;			/* 'B' (begin) or 'E' (end) */
+} traceRecord;
+
+/*
+*   DATA DEFINITIONS
+*/
+static traceRecord *Events = NULL;	/* ring buffer of events */
+static unsigned long EventCount = 0;	/* events recorded in total */
+static double Origin = 0.0;		/* time of first event */
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+/*  Records an event. The category and name must be static strings, since
+ *  only pointers to them are kept. Once the buffer is full, each new event
+ *  replaces the oldest one.
+ */
+extern void traceEvent (const int phase, const char *const category,
+			const char *const name, const char *const detail)
+{
+    traceRecord *event;
+
+    if (Events == NULL)
+    {
+	Events = xMalloc (TRACE_CAPACITY, traceRecord);
+	memset (Events, 0, TRACE_CAPACITY * sizeof (traceRecord));
+	Origin = profileClock ();
+    }
+    event = &Events [EventCount % TRACE_CAPACITY];
+    if (event->detail != NULL)
+	eFree (event->detail);
+    event->time     = profileClock () - Origin;
+    event->category = category;
+    event->name     = name;
+    event->detail   = detail == NULL ? NULL : eStrdup (detail);
+    event->phase    = phase;
+    ++EventCount;
+}
+
+static void writeTraceEvent (FILE *const fp, const traceRecord *const event)
+{
+    fprintf (fp, "{\"name\": ");
+    writeJsonString (fp, event->name);
+    fprintf (fp, ", \"cat\": ");
+    writeJsonString (fp, event->category);
+    fprintf (fp, ", \"ph\": \"%c\", \"ts\": %.03f, \"pid\": 1, \"tid\": 1",
+	    event->phase, event->time * 1e6);
+    if (event->detail != NULL)
+    {
+	fprintf (fp, ", \"args\": {\"detail\": ");
+	writeJsonString (fp, event->detail);
+	putc ('}', fp);
+    }
+    putc ('}', fp);
+}
+
+/*  Writes the events recorded to the file named by the --trace option.
+ */
+extern void writeTrace (void)
+{
+    const char *const fileName = Option.traceFile;
+    unsigned long first = 0;
+    unsigned long i;
+    FILE *fp;
+
+    if (fileName == NULL)
+	return;
+    fp = fopen (fileName, "w");
+    if (fp == NULL)
+    {
+	error (WARNING | PERROR, "cannot open trace file \"%s\"", fileName);
+	return;
+    }
+    if (EventCount > TRACE_CAPACITY)
+	first = EventCount - TRACE_CAPACITY;
+
+    fprintf (fp, "{\"traceEvents\": [");
+    for (i = first  ;  i < EventCount  ;  ++i)
+    {
+	fputs (i == first ? "\n" : ",\n", fp);
+	writeTraceEvent (fp, &Events [i % TRACE_CAPACITY]);
+    }
+    fprintf (fp, "\n],\n\"displayTimeUnit\": \"ms\",\n"
+	    "\"otherData\": {\"droppedEvents\": %lu}}\n", first);
+
+    if (fclose (fp) != 0)
+	error (WARNING | PERROR, "cannot write trace file \"%s\"", fileName);
+}
+
+extern void freeTraceResources (void)
+{
+    if (Events != NULL)
+    {
+	unsigned long i;
+	for (i = 0  ;  i < TRACE_CAPACITY  ;  ++i)
+	    if (Events [i].detail != NULL)
+		eFree (Events [i].detail);
+	eFree (Events);
+	Events = NULL;
+    }
+    EventCount = 0;
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,44 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to trace.c
+*/
+#ifndef _TRACE_H
+#define _TRACE_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include "options.h"
+
+/*
+*   MACROS
+*/
+
+/*  Trace events cost no more than a test of an option unless --trace is
+ *  given.
+ */
+#define isTracing()	(boolean) (Option.traceFile != NULL)
+
+#define traceBegin(category,name,detail) \
+	if (! isTracing ()) ; else traceEvent ('B', (category), (name), (detail))
+#define traceEnd(category,name) \
+	if (! isTracing ()) ; else traceEvent ('E', (category), (name), NULL)
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void traceEvent (const int phase, const char *const category, const char *const name, const char *const detail);
+extern void writeTrace (void);
+extern void freeTraceResources (void);
+
+#endif	/* _TRACE_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -131,15 +131,14 @@ extern vString *vStringNewInit (const char *const s)
 extern void vStringNCatS (vString *const string, const char *const s,
 			  const size_t length)
 {
-    const char *p = s;
-    size_t remain = length;
+    size_t len = 0;
 
-    while (*p != '\0'  &&  remain > 0)
-    {
-	vStringPut (string, *p);
-	--remain;
-	++p;
-    }
+    while (len < length  &&  s [len] != '\0')
+	++len;
+    while (string->length + len >= string->size)
+	vStringAutoResize (string);
+    memcpy (string->buffer + string->length, s, len);
+    string->length += len;
     vStringTerminate (string);
 }
 
@@ -229,4 +228,13 @@ extern void vStringSetLength (vString *const string)
     string->length = strlen (string->buffer);
 }
 
+/*  Discards all but the first "length" characters of a string.
+ */
+extern void vStringTruncate (vString *const string, const size_t length)
+{
+    Assert (length <= string->length);
+    string->length = length;
+    string->buffer [length] = '\0';
+}
+
 /* vi:set tabstop=8 shiftwidth=4: */
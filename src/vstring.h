@@ -78,6 +78,7 @@ extern void vStringCopyS (vString *const string, const char *const s);
 extern void vStringNCopyS (vString *const string, const char *const s, const size_t length);
 extern void vStringCopyToLower (vString *const dest, const vString *const src);
 extern void vStringSetLength (vString *const string);
+extern void vStringTruncate (vString *const string, const size_t length);
 
 #endif	/* _VSTRING_H */
 
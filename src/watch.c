@@ -0,0 +1,432 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   This module contains functions for keeping the tag file current after it
+*   has been generated (the --watch option). The tags of every source file
+*   are kept in memory; the directories walked are watched for changes
+*   (using inotify), each file changed is parsed again and the tag file is
+*   rewritten once the changes have settled.
+*/
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+#include <string.h>
+#include <stdio.h>
+#ifdef HAVE_SYS_INOTIFY_H
+# include <errno.h>
+# include <poll.h>
+# include <unistd.h>	/* to declare read () */
+# include <sys/inotify.h>
+#endif
+
+#include "debug.h"
+#include "dedup.h"
+#include "entry.h"
+#include "main.h"
+#include "options.h"
+#include "routines.h"
+#include "sort.h"
+#include "vstring.h"
+#include "watch.h"
+
+/*
+*   MACROS
+*/
+#define HASH_EXPONENT	10
+
+#define WATCH_DELAY		200	/* ms without changes before rewriting */
+#define EVENT_BUFFER_SIZE	65536
+
+#ifdef HAVE_SYS_INOTIFY_H
+# define WATCH_EVENTS	(IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | \
+			 IN_MOVED_FROM | IN_MOVED_TO)
+#endif
+
+/*
+*   DATA DECLARATIONS
+*/
+
+typedef struct sWatchedFile {
+    struct sWatchedFile *next;
+    char *name;			/* name of source file, as parsed */
+    vString *tags;		/* tags generated for the file */
+} watchedFile;
+
+typedef struct sWatchedDirectory {
+    struct sWatchedDirectory *next;
+    int descriptor;		/* inotify watch descriptor */
+    char *prefix;		/* prefixed to names of entries */
+    boolean recursed;		/* are new entries to be parsed? */
+} watchedDirectory;
+
+/*
+*   DATA DEFINITIONS
+*/
+static const unsigned int TableSize = 1 << HASH_EXPONENT;
+static watchedFile *Files [1 << HASH_EXPONENT];
+static watchedDirectory *Directories [1 << HASH_EXPONENT];
+static int Inotify = -1;
+static boolean Changed = FALSE;		/* tags changed since last written */
+
+/*
+*   FUNCTION DEFINITIONS
+*/
+
+static unsigned int hashName (const char *const name)
+{
+    unsigned long hash = 2166136261UL;
+    const unsigned char *p;
+
+    for (p = (const unsigned char *) name  ;  *p != '\0'  ;  ++p)
+    {
+	hash ^= *p;
+	hash = (hash * 16777619UL) & 0xffffffffUL;
+    }
+    return (unsigned int) (hash & (TableSize - 1));
+}
+
+static watchedFile **findFile (const char *const name)
+{
+    watchedFile **file = &Files [hashName (name)];
+    while (*file != NULL  &&  strcmp ((*file)->name, name) != 0)
+	file = &(*file)->next;
+    return file;
+}
+
+static void deleteFile (watchedFile **const file)
+{
+    watchedFile *const next = (*file)->next;
+    eFree ((*file)->name);
+    vStringDelete ((*file)->tags);
+    eFree (*file);
+    *file = next;
+    Changed = TRUE;
+}
+
+/*  Discards the tags of a file. Returns TRUE if the file was known.
+ */
+static boolean forgetFile (const char *const name)
+{
+    watchedFile **const file = findFile (name);
+    boolean known = FALSE;
+    if (*file != NULL)
+    {
+	deleteFile (file);
+	known = TRUE;
+    }
+    return known;
+}
+
+/*  Discards the tags of all files whose names begin with "prefix" (i.e.
+ *  those within a directory which has been removed).
+ */
+static void forgetFilesUnder (const char *const prefix)
+{
+    const size_t length = strlen (prefix);
+    unsigned int i;
+
+    for (i = 0  ;  i < TableSize  ;  ++i)
+    {
+	watchedFile **file = &Files [i];
+	while (*file != NULL)
+	{
+	    if (strncmp ((*file)->name, prefix, length) == 0)
+		deleteFile (file);
+	    else
+		file = &(*file)->next;
+	}
+    }
+}
+
+static watchedDirectory *findDirectory (const char *const prefix)
+{
+    watchedDirectory *dir = Directories [hashName (prefix)];
+    while (dir != NULL  &&  strcmp (dir->prefix, prefix) != 0)
+	dir = dir->next;
+    return dir;
+}
+
+static void addWatch (const char *const prefix, const boolean recursed)
+{
+    watchedDirectory *dir = findDirectory (prefix);
+    if (dir != NULL)
+    {
+	if (recursed)
+	    dir->recursed = TRUE;
+    }
+#ifdef HAVE_SYS_INOTIFY_H
+    else
+    {
+	const char *const path = *prefix == '\0' ? "." : prefix;
+	int descriptor;
+
+	if (Inotify == -1)
+	{
+	    Inotify = inotify_init ();
+	    if (Inotify == -1)
+		error (FATAL | PERROR, "cannot watch for changes");
+	}
+	descriptor = inotify_add_watch (Inotify, path, WATCH_EVENTS);
+	if (descriptor == -1)
+	    error (WARNING | PERROR, "cannot watch \"%s\"", path);
+	else
+	{
+	    const unsigned int i = hashName (prefix);
+	    dir = xMalloc (1, watchedDirectory);
+	    dir->descriptor = descriptor;
+	    dir->prefix     = eStrdup (prefix);
+	    dir->recursed   = recursed;
+	    dir->next       = Directories [i];
+	    Directories [i] = dir;
+	}
+    }
+#endif
+}
+
+/*  Called for each directory walked. New entries in it will be parsed.
+ */
+extern void watchDirectory (const char *const dirName)
+{
+    if (strcmp (dirName, ".") == 0)
+	addWatch ("", TRUE);
+    else
+    {
+	vString *const prefix = combinePathAndFile (dirName, "");
+	addWatch (vStringValue (prefix), TRUE);
+	vStringDelete (prefix);
+    }
+}
+
+/*  Called after each file has been parsed, to take its tags. The directory
+ *  containing the file is watched if it was not walked (i.e. the file was
+ *  named explicitly), but only changes to files already known are parsed.
+ */
+extern void watchCaptureTags (const char *const fileName)
+{
+    watchedFile **const file = findFile (fileName);
+    vString *tags;
+    char *prefix;
+
+    if (*file == NULL)
+    {
+	*file = xMalloc (1, watchedFile);
+	(*file)->next = NULL;
+	(*file)->name = eStrdup (fileName);
+	(*file)->tags = vStringNew ();
+    }
+    /*  Exchange buffers rather than copying the tags.
+     */
+    vStringTerminate (TagFile.output);
+    tags = (*file)->tags;
+    (*file)->tags = TagFile.output;
+    TagFile.output = tags;
+    vStringClear (TagFile.output);
+    Changed = TRUE;
+
+    prefix = eStrdup (fileName);
+    prefix [baseFilename (fileName) - fileName] = '\0';
+    addWatch (prefix, FALSE);
+    eFree (prefix);
+}
+
+/*  Writes the tag file from the tags of all files.
+ */
+extern void writeWatchedTags (void)
+{
+    vString *const tags = vStringNew ();
+    unsigned int i;
+
+    for (i = 0  ;  i < TableSize  ;  ++i)
+    {
+	const watchedFile *file;
+	for (file = Files [i]  ;  file != NULL  ;  file = file->next)
+	    vStringCat (tags, file->tags);
+    }
+    if (Option.sorted != SO_UNSORTED)
+	sortTagBuffer (tags);
+    replaceTagFile (tags);
+    vStringDelete (tags);
+    Changed = FALSE;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+static watchedDirectory **findDescriptor (const int descriptor)
+{
+    watchedDirectory **dir = NULL;
+    unsigned int i;
+
+    for (i = 0  ;  i < TableSize  &&  dir == NULL  ;  ++i)
+    {
+	watchedDirectory **d;
+	for (d = &Directories [i]  ;  *d != NULL  ;  d = &(*d)->next)
+	    if ((*d)->descriptor == descriptor)
+	    {
+		dir = d;
+		break;
+	    }
+    }
+    return dir;
+}
+
+/*  Is this our own tag file, or its replacement being written?
+ */
+static boolean isTagFilePath (const char *const path)
+{
+    const char *const name = tagFileName ();
+    const size_t length = strlen (name);
+
+    return (boolean) (strncmp (path, name, length) == 0  &&
+	    (path [length] == '\0'  ||
+	     strcmp (path + length, NEW_TAG_FILE_SUFFIX) == 0));
+}
+
+static void handleEntryEvent (const watchedDirectory *const dir,
+			      const struct inotify_event *const event)
+{
+    vString *const path = vStringNewInit (dir->prefix);
+    vStringCatS (path, event->name);
+
+    if (isTagFilePath (vStringValue (path)))
+	;
+    else if (event->mask & IN_ISDIR)
+    {
+	if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+	{
+	    vString *const prefix = combinePathAndFile (vStringValue (path), "");
+	    forgetFilesUnder (vStringValue (prefix));
+	    vStringDelete (prefix);
+	}
+	else if (dir->recursed)
+	    createTagsForEntry (vStringValue (path));
+    }
+    else
+    {
+	const boolean known = forgetFile (vStringValue (path));
+	if ((event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))  &&
+	    (known  ||  dir->recursed))
+	{
+	    verbose ("%s changed\n", vStringValue (path));
+	    createTagsForEntry (vStringValue (path));
+	}
+    }
+    vStringDelete (path);
+}
+
+static void handleEvent (const struct inotify_event *const event)
+{
+    watchedDirectory **const dir = findDescriptor (event->wd);
+
+    if (event->mask & IN_Q_OVERFLOW)
+	error (WARNING, "changes were missed; tag file may be out of date");
+    else if (dir == NULL)
+	;
+    else if (event->mask & IN_IGNORED)	/* directory has gone */
+    {
+	watchedDirectory *const next = (*dir)->next;
+	eFree ((*dir)->prefix);
+	eFree (*dir);
+	*dir = next;
+    }
+    else if (event->len > 0)
+	handleEntryEvent (*dir, event);
+}
+
+/*  Waits for events to arrive, for at most "timeout" milliseconds (or
+ *  indefinitely if negative). Returns TRUE if there are events to read.
+ */
+static boolean waitForEvents (const int timeout)
+{
+    struct pollfd fd;
+    int result;
+
+    fd.fd = Inotify;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    result = poll (&fd, 1, timeout);
+    if (result == -1  &&  errno != EINTR)
+	error (FATAL | PERROR, "cannot wait for changes");
+    return (boolean) (result > 0);
+}
+
+static void readEvents (char *const buffer)
+{
+    const long length = (long) read (Inotify, buffer, EVENT_BUFFER_SIZE);
+    long offset = 0;
+
+    if (length == -1  &&  errno != EINTR)
+	error (FATAL | PERROR, "cannot read changes");
+    while (offset < length)
+    {
+	const struct inotify_event *const event =
+		(const struct inotify_event *) (buffer + offset);
+	handleEvent (event);
+	offset += (long) sizeof (struct inotify_event) + (long) event->len;
+    }
+}
+
+#endif
+
+/*  Watches for changes until interrupted. Changes arriving within
+ *  WATCH_DELAY milliseconds of each other (e.g. a save of several files)
+ *  result in a single rewrite of the tag file.
+ */
+extern void watchForChanges (void)
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    char *const buffer = xMalloc (EVENT_BUFFER_SIZE, char);
+
+    if (Inotify == -1)
+	error (FATAL, "no directories to watch");
+    verbose ("watching for changes\n");
+    for (;;)
+    {
+	int timeout = -1;
+
+	while (waitForEvents (timeout))
+	{
+	    readEvents (buffer);
+	    timeout = WATCH_DELAY;
+	}
+	if (Changed)
+	{
+	    verbose ("writing %s\n", tagFileName ());
+	    writeWatchedTags ();
+	}
+	dedupForget ();		/* forget contents of changed files */
+    }
+#endif
+}
+
+extern void freeWatchResources (void)
+{
+    unsigned int i;
+
+    for (i = 0  ;  i < TableSize  ;  ++i)
+    {
+	while (Files [i] != NULL)
+	    deleteFile (&Files [i]);
+	while (Directories [i] != NULL)
+	{
+	    watchedDirectory *const next = Directories [i]->next;
+	    eFree (Directories [i]->prefix);
+	    eFree (Directories [i]);
+	    Directories [i] = next;
+	}
+    }
+#ifdef HAVE_SYS_INOTIFY_H
+    if (Inotify != -1)
+	close (Inotify);
+    Inotify = -1;
+#endif
+}
+
+/* vi:set tabstop=8 shiftwidth=4: */
@@ -0,0 +1,30 @@
+/*
+*   $Id$
+*
+*   Copyright (c) 2026, amigazen project
+*
+*   This source code is released for free distribution under the terms of the
+*   GNU General Public License.
+*
+*   External interface to watch.c
+*/
+#ifndef _WATCH_H
+#define _WATCH_H
+
+/*
+*   INCLUDE FILES
+*/
+#include "general.h"	/* must always come first */
+
+/*
+*   FUNCTION PROTOTYPES
+*/
+extern void watchDirectory (const char *const dirName);
+extern void watchCaptureTags (const char *const fileName);
+extern void writeWatchedTags (void);
+extern void watchForChanges (void);
+extern void freeWatchResources (void);
+
+#endif	/* _WATCH_H */
+
+/* vi:set tabstop=8 shiftwidth=4: */